@@ -12,20 +12,27 @@ public class FancyFolders : ModuleRules
 
 		PrivateDependencyModuleNames.AddRange(new []
 		{
+			"AssetRegistry",
 			"AssetTools",
 			"ContentBrowser",
 			"ContentBrowserData",
 			"Core",
 			"CoreUObject",
 			"DeveloperSettings",
+			"DirectoryWatcher",
 			"EditorSubsystem",
 			"Engine",
 			"InputCore",
+			"Json",
 			"Projects", 
+			"RHI",
 			"Slate",
 			"SlateCore",
 			"ToolMenus",
 			"UnrealEd",
 		});
+
+		// Used to rasterize the folder icons into the icon atlas
+		AddEngineThirdPartyPrivateStaticDependencies(Target, "nanosvg");
 	}
 }
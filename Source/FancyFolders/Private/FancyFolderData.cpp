@@ -9,6 +9,16 @@
 #include "FancyFolders.h"
 #include "FancyFoldersStyle.h"
 
+EFolderState StateFromFlags(bool bIsColumnView, bool bIsOpen)
+{
+	if (bIsColumnView)
+	{
+		return bIsOpen ? EFolderState::ColumnOpen : EFolderState::ColumnClosed;
+	}
+
+	return EFolderState::Normal;
+}
+
 FFolderData::FFolderData()
 {
 	Icon = TEXT("Default");
@@ -23,24 +33,8 @@ FFolderData::FFolderData(const FName& InIcon, const FLinearColor& InColor)
 
 const FSlateBrush* FFolderData::GetIcon(EFolderState State) const
 {
-	const FString IconType = [=]()
-	{
-		switch (State)
-		{
-		case EFolderState::Normal:
-			return TEXT("Normal");
-		case EFolderState::ColumnOpen:
-			return TEXT("ColumnOpen");
-		case EFolderState::ColumnClosed:
-			return TEXT("ColumnClosed");
-		}
-
-		checkNoEntry();
-		return TEXT("");
-	}();
-
-	const FName Brush = *FString::Printf(TEXT("%s.%s"), *Icon.ToString(), *IconType);
-	return FFancyFoldersStyle::Get().GetBrush(Brush);
+	FFancyFoldersStyle& Style = FFancyFoldersStyle::Get();
+	return Style.GetFolderBrush(Style.FindIconIndex(Icon), State);
 }
 
 void FFolderDataCustomization::CustomizeHeader(TSharedRef<IPropertyHandle> PropertyHandle, FDetailWidgetRow& HeaderRow, IPropertyTypeCustomizationUtils& CustomizationUtils)
@@ -51,9 +45,10 @@ void FFolderDataCustomization::CustomizeChildren(TSharedRef<IPropertyHandle> Str
 {
 	FolderIcon = StructPropertyHandle->GetChildHandle(GET_MEMBER_NAME_CHECKED(FFolderData, Icon));
 
-	for (const FString& IconAvailable : FFancyFoldersModule::GetIconFoldersOnDisk())
+	const TArray<FString>& IconNames = FFancyFoldersModule::GetIconManifest().IconNames;
+	IconsList.Reserve(IconNames.Num());
+	for (const FString& IconName : IconNames)
 	{
-		const FString IconName = FPaths::GetBaseFilename(IconAvailable);
 		IconsList.Add(MakeShared<FString>(IconName));
 	}
 
@@ -122,8 +117,9 @@ FSlateColor FFolderDataCustomization::GetCurrentColor() const
 
 const FSlateBrush* FFolderDataCustomization::GetCurrentBrush() const
 {
-	FString IconValue;
-	FolderIcon->GetValueAsDisplayString(IconValue);
+	FName IconValue;
+	FolderIcon->GetValue(IconValue);
 
-	return FFancyFoldersStyle::Get().GetBrush(*FString::Printf(TEXT("%s.Normal"), *IconValue));
+	FFancyFoldersStyle& Style = FFancyFoldersStyle::Get();
+	return Style.GetFolderBrush(Style.FindIconIndex(IconValue), EFolderState::Normal);
 }
@@ -3,26 +3,125 @@
 #include "FancyFolders.h"
 
 #include <ContentBrowserMenuContexts.h>
+#include <DirectoryWatcherModule.h>
+#include <IDirectoryWatcher.h>
 #include <Interfaces/IPluginManager.h>
 #include <ToolMenus.h>
 
 #include "FancyFoldersSettings.h"
 #include "FancyFoldersSubsystem.h"
 
-TArray<FString> FFancyFoldersModule::GetIconFoldersOnDisk()
+DEFINE_LOG_CATEGORY(LogFancyFolders);
+
+namespace FancyFoldersModuleHelpers
+{
+	FFancyFoldersIconManifest& AccessIconManifest()
+	{
+		static FFancyFoldersIconManifest IconManifest;
+		return IconManifest;
+	}
+} // namespace FancyFoldersModuleHelpers
+
+const TArray<FString>& FFancyFoldersModule::GetIconFoldersOnDisk()
+{
+	return GetIconManifest().IconFolders;
+}
+
+const FFancyFoldersIconManifest& FFancyFoldersModule::GetIconManifest()
 {
-	const FString ResourcesFolder = IPluginManager::Get().FindPlugin("FancyFolders")->GetBaseDir() / TEXT("Resources") / TEXT("Icons") + TEXT("/");
+	FFancyFoldersIconManifest& IconManifest = FancyFoldersModuleHelpers::AccessIconManifest();
+
+	// The first access scans the disk, later ones only rescan once the directory watcher reports a change
+	static bool bScanned = false;
+	if (!bScanned)
+	{
+		bScanned = true;
+		ScanIconManifest(IconManifest);
+	}
+
+	return IconManifest;
+}
+
+FSimpleMulticastDelegate& FFancyFoldersModule::OnIconManifestChanged()
+{
+	static FSimpleMulticastDelegate IconManifestChanged;
+	return IconManifestChanged;
+}
+
+FString FFancyFoldersModule::GetIconsRootFolder()
+{
+	return IPluginManager::Get().FindPlugin("FancyFolders")->GetBaseDir() / TEXT("Resources") / TEXT("Icons") + TEXT("/");
+}
+
+bool FFancyFoldersModule::ScanIconManifest(FFancyFoldersIconManifest& Manifest)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FFancyFoldersModule::ScanIconManifest)
+
+	const FString ResourcesFolder = GetIconsRootFolder();
 	const FString IconsFolder = ResourcesFolder + TEXT("*");
 
 	TArray<FString> FoundDirectories;
 	IFileManager::Get().FindFiles(FoundDirectories, *IconsFolder, false, true);
+	FoundDirectories.Sort();
 
 	for (auto& Directory : FoundDirectories)
 	{
 		Directory.InsertAt(0, ResourcesFolder);
 	}
 
-	return FoundDirectories;
+	if (FoundDirectories == Manifest.IconFolders && Manifest.Version != 0)
+	{
+		return false;
+	}
+
+	Manifest.IconNames.Reset(FoundDirectories.Num());
+	for (const FString& Directory : FoundDirectories)
+	{
+		Manifest.IconNames.Add(FPaths::GetBaseFilename(Directory));
+	}
+
+	Manifest.IconFolders = MoveTemp(FoundDirectories);
+	Manifest.Version++;
+	return true;
+}
+
+void FFancyFoldersModule::WatchIconFolders()
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FFancyFoldersModule::WatchIconFolders)
+
+	// Commandlets never draw icons, so they don't need to hear about them changing
+	if (IsRunningCommandlet())
+	{
+		return;
+	}
+
+	FFancyFoldersModule& Module = FModuleManager::GetModuleChecked<FFancyFoldersModule>(TEXT("FancyFolders"));
+	if (Module.IconFolderWatcherHandle.IsValid())
+	{
+		return;
+	}
+
+	FDirectoryWatcherModule& DirectoryWatcherModule = FModuleManager::LoadModuleChecked<FDirectoryWatcherModule>(TEXT("DirectoryWatcher"));
+	if (IDirectoryWatcher* DirectoryWatcher = DirectoryWatcherModule.Get())
+	{
+		DirectoryWatcher->RegisterDirectoryChangedCallback_Handle(
+			GetIconsRootFolder(),
+			IDirectoryWatcher::FDirectoryChanged::CreateRaw(&Module, &FFancyFoldersModule::OnIconFolderChanged),
+			Module.IconFolderWatcherHandle,
+			IDirectoryWatcher::WatchOptions::IncludeDirectoryChanges
+		);
+	}
+}
+
+void FFancyFoldersModule::OnIconFolderChanged(const TArray<FFileChangeData>& FileChanges)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FFancyFoldersModule::OnIconFolderChanged)
+
+	// Only sub folders being added, removed or renamed change the manifest, svg edits are picked up by the brushes themselves
+	if (ScanIconManifest(FancyFoldersModuleHelpers::AccessIconManifest()))
+	{
+		OnIconManifestChanged().Broadcast();
+	}
 }
 
 void FFancyFoldersModule::StartupModule()
@@ -39,6 +138,16 @@ void FFancyFoldersModule::ShutdownModule()
 {
 	UToolMenus::UnregisterOwner(this);
 
+	FDirectoryWatcherModule* DirectoryWatcherModule = FModuleManager::GetModulePtr<FDirectoryWatcherModule>(TEXT("DirectoryWatcher"));
+	if (IconFolderWatcherHandle.IsValid() && DirectoryWatcherModule)
+	{
+		if (IDirectoryWatcher* DirectoryWatcher = DirectoryWatcherModule->Get())
+		{
+			DirectoryWatcher->UnregisterDirectoryChangedCallback_Handle(GetIconsRootFolder(), IconFolderWatcherHandle);
+		}
+		IconFolderWatcherHandle.Reset();
+	}
+
 	if (FPropertyEditorModule* PropertyModule = FModuleManager::GetModulePtr<FPropertyEditorModule>("PropertyEditor"))
 	{
 		PropertyModule->UnregisterCustomPropertyTypeLayout("FolderData");
@@ -74,10 +183,8 @@ void FFancyFoldersModule::BuildContextMenu(FMenuBuilder& MenuBuilder, UContentBr
 		}
 	}
 
-	TArray<FString> IconsAvailable = GetIconFoldersOnDisk();
-	for (const FString& IconPath : IconsAvailable)
+	for (const FString& IconName : GetIconManifest().IconNames)
 	{
-		const FString IconName = FPaths::GetBaseFilename(IconPath);
 		MenuBuilder.AddMenuEntry(
 			FText::FromString(IconName),
 			FText::Format(INVTEXT("Set {0} as the folder's icon."), FText::FromString(IconName)),
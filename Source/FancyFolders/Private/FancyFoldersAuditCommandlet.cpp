@@ -0,0 +1,211 @@
+﻿// Copyright Out-of-the-Box Plugins 2018-2025. All Rights Reserved.
+
+#include "FancyFoldersAuditCommandlet.h"
+
+#include <AssetRegistry/IAssetRegistry.h>
+#include <Async/ParallelFor.h>
+#include <Misc/FileHelper.h>
+#include <Misc/Paths.h>
+#include <Policies/PrettyJsonPrintPolicy.h>
+#include <Serialization/JsonWriter.h>
+
+#include "FancyFolders.h"
+#include "FancyFoldersSettings.h"
+
+UFancyFoldersAuditCommandlet::UFancyFoldersAuditCommandlet()
+{
+	IsClient = false;
+	IsEditor = true;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+int32 UFancyFoldersAuditCommandlet::Main(const FString& Params)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(UFancyFoldersAuditCommandlet::Main)
+
+	FString OutputFile;
+	if (!FParse::Value(*Params, TEXT("Output="), OutputFile))
+	{
+		OutputFile = FPaths::ProjectSavedDir() / TEXT("FancyFolders") / FString::Printf(TEXT("Audit-%s.json"), *FDateTime::Now().ToString());
+	}
+
+	TArray<FString> Roots;
+	FString RootsValue;
+	if (FParse::Value(*Params, TEXT("Root="), RootsValue, false))
+	{
+		RootsValue.ParseIntoArray(Roots, TEXT(","));
+	}
+
+	IAssetRegistry& AssetRegistry = IAssetRegistry::GetChecked();
+	AssetRegistry.SearchAllAssets(true);
+
+	TArray<FString> FolderPaths;
+	AssetRegistry.GetAllCachedPaths(FolderPaths);
+
+	if (!Roots.IsEmpty())
+	{
+		FolderPaths.RemoveAll(
+			[&Roots](const FString& Path)
+			{
+				return !Roots.ContainsByPredicate(
+					[&Path](const FString& Root)
+					{
+						return FPaths::IsUnderDirectory(Path, Root);
+					}
+				);
+			}
+		);
+	}
+
+	FolderPaths.Sort();
+
+	// The rules are only read from here on, so they can be resolved from all the workers at once without going through the settings' cache
+	const UFancyFoldersSettings* Settings = GetDefault<UFancyFoldersSettings>();
+	const FFancyFoldersRuleSet& Rules = Settings->Rules;
+
+	TArray<FFancyFoldersRuleMatch> Matches;
+	Matches.SetNum(FolderPaths.Num());
+
+	const double StartTime = FPlatformTime::Seconds();
+
+	ParallelFor(
+		TEXT("FancyFoldersAudit"),
+		FolderPaths.Num(),
+		256,
+		[&Rules, &FolderPaths, &Matches](int32 PathIndex)
+		{
+			Rules.Resolve(FolderPaths[PathIndex], &Matches[PathIndex]);
+		}
+	);
+
+	const double ResolveSeconds = FPlatformTime::Seconds() - StartTime;
+
+	TMap<FString, int32> AssignmentHits;
+	TMap<FString, int32> InheritedHits;
+	TArray<int32> FolderPresetHits;
+	TArray<int32> PathPresetHits;
+	TArray<int32> UnmatchedFolders;
+	FolderPresetHits.SetNumZeroed(Settings->FolderPresets.Num());
+	PathPresetHits.SetNumZeroed(Settings->PathPresets.Num());
+
+	for (int32 PathIndex = 0; PathIndex < FolderPaths.Num(); PathIndex++)
+	{
+		const FFancyFoldersRuleMatch& Match = Matches[PathIndex];
+		switch (Match.Kind)
+		{
+		case EFancyFoldersRuleKind::Assignment:
+			AssignmentHits.FindOrAdd(FolderPaths[PathIndex])++;
+			break;
+		case EFancyFoldersRuleKind::InheritedAssignment:
+			InheritedHits.FindOrAdd(FolderPaths[PathIndex].Left(Match.AssignedPathLength))++;
+			break;
+		case EFancyFoldersRuleKind::FolderPreset:
+			FolderPresetHits[Match.PresetIndex]++;
+			break;
+		case EFancyFoldersRuleKind::PathPreset:
+			PathPresetHits[Match.PresetIndex]++;
+			break;
+		default:
+			UnmatchedFolders.Add(PathIndex);
+			break;
+		}
+	}
+
+	int32 NumDeadRules = 0;
+
+	FString Output;
+	const TSharedRef<TJsonWriter<TCHAR, TPrettyJsonPrintPolicy<TCHAR>>> Writer = TJsonWriterFactory<TCHAR, TPrettyJsonPrintPolicy<TCHAR>>::Create(&Output);
+
+	Writer->WriteObjectStart();
+	Writer->WriteValue(TEXT("Folders"), FolderPaths.Num());
+	Writer->WriteValue(TEXT("MatchedFolders"), FolderPaths.Num() - UnmatchedFolders.Num());
+	Writer->WriteValue(TEXT("UnmatchedFolders"), UnmatchedFolders.Num());
+	Writer->WriteValue(TEXT("ResolveSeconds"), ResolveSeconds);
+
+	Writer->WriteArrayStart(TEXT("Assignments"));
+	for (const FPathAssignedData& Assignment : Settings->PathAssignments)
+	{
+		const int32 NumFolders = AssignmentHits.FindRef(Assignment.Path);
+		const int32 NumSubfolders = InheritedHits.FindRef(Assignment.Path);
+		const bool bDead = NumFolders + NumSubfolders == 0;
+		NumDeadRules += bDead ? 1 : 0;
+
+		UE_CLOG(bDead, LogFancyFolders, Display, TEXT("Dead assignment: %s"), *Assignment.Path);
+
+		Writer->WriteObjectStart();
+		Writer->WriteValue(TEXT("Path"), Assignment.Path);
+		Writer->WriteValue(TEXT("ApplyToSubfolders"), Assignment.bApplyToSubfolders);
+		Writer->WriteValue(TEXT("Folders"), NumFolders);
+		Writer->WriteValue(TEXT("Subfolders"), NumSubfolders);
+		Writer->WriteValue(TEXT("Dead"), bDead);
+		Writer->WriteObjectEnd();
+	}
+	Writer->WriteArrayEnd();
+
+	Writer->WriteArrayStart(TEXT("FolderPresets"));
+	for (int32 PresetIndex = 0; PresetIndex < Settings->FolderPresets.Num(); PresetIndex++)
+	{
+		const bool bDead = FolderPresetHits[PresetIndex] == 0;
+		NumDeadRules += bDead ? 1 : 0;
+
+		UE_CLOG(bDead, LogFancyFolders, Display, TEXT("Dead folder preset %d: %s"), PresetIndex, *Settings->FolderPresets[PresetIndex].FolderRegex);
+
+		Writer->WriteObjectStart();
+		Writer->WriteValue(TEXT("Index"), PresetIndex);
+		Writer->WriteValue(TEXT("FolderRegex"), Settings->FolderPresets[PresetIndex].FolderRegex);
+		Writer->WriteValue(TEXT("Folders"), FolderPresetHits[PresetIndex]);
+		Writer->WriteValue(TEXT("Dead"), bDead);
+		Writer->WriteObjectEnd();
+	}
+	Writer->WriteArrayEnd();
+
+	Writer->WriteArrayStart(TEXT("PathPresets"));
+	for (int32 PresetIndex = 0; PresetIndex < Settings->PathPresets.Num(); PresetIndex++)
+	{
+		const bool bDead = PathPresetHits[PresetIndex] == 0;
+		NumDeadRules += bDead ? 1 : 0;
+
+		UE_CLOG(bDead, LogFancyFolders, Display, TEXT("Dead path preset %d: %s"), PresetIndex, *Settings->PathPresets[PresetIndex].PathRegex);
+
+		Writer->WriteObjectStart();
+		Writer->WriteValue(TEXT("Index"), PresetIndex);
+		Writer->WriteValue(TEXT("PathRegex"), Settings->PathPresets[PresetIndex].PathRegex);
+		Writer->WriteValue(TEXT("Folders"), PathPresetHits[PresetIndex]);
+		Writer->WriteValue(TEXT("Dead"), bDead);
+		Writer->WriteObjectEnd();
+	}
+	Writer->WriteArrayEnd();
+
+	Writer->WriteValue(TEXT("DeadRules"), NumDeadRules);
+
+	Writer->WriteArrayStart(TEXT("Unmatched"));
+	for (const int32 PathIndex : UnmatchedFolders)
+	{
+		Writer->WriteValue(FolderPaths[PathIndex]);
+	}
+	Writer->WriteArrayEnd();
+
+	Writer->WriteObjectEnd();
+	Writer->Close();
+
+	UE_LOG(
+		LogFancyFolders,
+		Display,
+		TEXT("Resolved %d folders in %.3f s: %d matched, %d unmatched, %d dead rules"),
+		FolderPaths.Num(),
+		ResolveSeconds,
+		FolderPaths.Num() - UnmatchedFolders.Num(),
+		UnmatchedFolders.Num(),
+		NumDeadRules
+	);
+
+	if (!FFileHelper::SaveStringToFile(Output, *OutputFile))
+	{
+		UE_LOG(LogFancyFolders, Error, TEXT("Failed to write the audit report to %s"), *OutputFile);
+		return 1;
+	}
+
+	UE_LOG(LogFancyFolders, Display, TEXT("Audit report written to %s"), *OutputFile);
+	return 0;
+}
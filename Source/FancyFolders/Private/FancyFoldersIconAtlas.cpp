@@ -0,0 +1,245 @@
+﻿// Copyright Out-of-the-Box Plugins 2018-2025. All Rights Reserved.
+
+#include "FancyFoldersIconAtlas.h"
+
+#include <Brushes/SlateImageBrush.h>
+#include <Engine/Texture2D.h>
+#include <Misc/FileHelper.h>
+#include <RHI.h>
+
+THIRD_PARTY_INCLUDES_START
+#define NANOSVG_IMPLEMENTATION
+#define NANOSVGRAST_IMPLEMENTATION
+#include <nanosvg.h>
+#include <nanosvgrast.h>
+THIRD_PARTY_INCLUDES_END
+
+namespace IconAtlasHelpers
+{
+	/**
+	 * Icon rasterized on the CPU, waiting to be packed into the atlas
+	 */
+	struct FRasterizedIcon
+	{
+		int32 BrushIndex = INDEX_NONE;
+		FVector2D ImageSize;
+		FIntPoint PixelSize;
+		int32 Page = INDEX_NONE;
+		FIntPoint AtlasPosition;
+		TArray<uint8> Pixels;
+	};
+
+	bool RasterizeSvg(NSVGrasterizer* Rasterizer, const FString& File, int32 TargetSize, FRasterizedIcon& OutIcon)
+	{
+		TRACE_CPUPROFILER_EVENT_SCOPE(FancyFolders::IconAtlasHelpers::RasterizeSvg)
+
+		FString FileContent;
+		if (!FFileHelper::LoadFileToString(FileContent, *File))
+		{
+			return false;
+		}
+
+		// nanosvg modifies the buffer while parsing, so it needs it's own null terminated copy
+		const FTCHARToUTF8 Utf8Content(*FileContent);
+		TArray<char> Buffer(Utf8Content.Get(), Utf8Content.Length());
+		Buffer.Add('\0');
+
+		NSVGimage* Image = nsvgParse(Buffer.GetData(), "px", 96.0f);
+		if (!Image || Image->width <= 0.0f || Image->height <= 0.0f)
+		{
+			nsvgDelete(Image);
+			return false;
+		}
+
+		const float Scale = TargetSize / FMath::Max(Image->width, Image->height);
+		OutIcon.PixelSize = FIntPoint(FMath::CeilToInt(Image->width * Scale), FMath::CeilToInt(Image->height * Scale));
+		OutIcon.Pixels.SetNumZeroed(OutIcon.PixelSize.X * OutIcon.PixelSize.Y * 4);
+
+		nsvgRasterize(Rasterizer, Image, 0.0f, 0.0f, Scale, OutIcon.Pixels.GetData(), OutIcon.PixelSize.X, OutIcon.PixelSize.Y, OutIcon.PixelSize.X * 4);
+		nsvgDelete(Image);
+		return true;
+	}
+} // namespace IconAtlasHelpers
+
+bool FFancyFoldersIconAtlas::Build(const TArray<FString>& IconFolders, int32 MaxPageDimension)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FFancyFoldersIconAtlas::Build)
+
+	using namespace IconAtlasHelpers;
+
+	struct FStateSource
+	{
+		const TCHAR* File;
+		double Size;
+	};
+
+	// Same order and sizes as the vector brushes of FFancyFoldersStyle
+	const FStateSource StateSources[NumFolderStates] = {
+		{TEXT("Normal.svg"), 64.0},
+		{TEXT("ColumnOpen.svg"), 16.0},
+		{TEXT("ColumnClosed.svg"), 16.0},
+	};
+
+	TArray<FRasterizedIcon> Icons;
+	Icons.Reserve(IconFolders.Num() * NumFolderStates);
+
+	NSVGrasterizer* Rasterizer = nsvgCreateRasterizer();
+	for (int32 IconIndex = 0; IconIndex < IconFolders.Num(); IconIndex++)
+	{
+		for (int32 State = 0; State < NumFolderStates; State++)
+		{
+			FRasterizedIcon Icon;
+			Icon.BrushIndex = IconIndex * NumFolderStates + State;
+			Icon.ImageSize = FVector2D(StateSources[State].Size);
+
+			const int32 TargetSize = FMath::CeilToInt(StateSources[State].Size * RasterScale);
+			if (RasterizeSvg(Rasterizer, IconFolders[IconIndex] / StateSources[State].File, TargetSize, Icon))
+			{
+				Icons.Add(MoveTemp(Icon));
+			}
+		}
+	}
+	nsvgDeleteRasterizer(Rasterizer);
+
+	if (Icons.IsEmpty())
+	{
+		return false;
+	}
+
+	// Simple shelf packing, tallest icons first so each shelf wastes as little space as possible
+	Icons.Sort(
+		[](const FRasterizedIcon& Lhs, const FRasterizedIcon& Rhs)
+		{
+			return Lhs.PixelSize.Y > Rhs.PixelSize.Y;
+		}
+	);
+
+	// A texture larger than the RHI supports would fail to create, so the icons are split over several pages instead
+	const int32 MaxDimension = MaxPageDimension > 0 ? MaxPageDimension : static_cast<int32>(GetMax2DTextureDimension());
+	const int32 PageWidth = FMath::Min(AtlasWidth, MaxDimension);
+
+	TArray<int32> PageHeights = {0};
+	FIntPoint Cursor(Padding, Padding);
+	int32 ShelfHeight = 0;
+	for (FRasterizedIcon& Icon : Icons)
+	{
+		// Icons which don't even fit an empty page keep using their vector brush
+		if (Icon.PixelSize.X + 2 * Padding > PageWidth || Icon.PixelSize.Y + 2 * Padding > MaxDimension)
+		{
+			continue;
+		}
+
+		if (Cursor.X + Icon.PixelSize.X + Padding > PageWidth)
+		{
+			Cursor = FIntPoint(Padding, Cursor.Y + ShelfHeight + Padding);
+			ShelfHeight = 0;
+		}
+
+		if (Cursor.Y + Icon.PixelSize.Y + Padding > MaxDimension)
+		{
+			PageHeights.Add(0);
+			Cursor = FIntPoint(Padding, Padding);
+			ShelfHeight = 0;
+		}
+
+		Icon.Page = PageHeights.Num() - 1;
+		Icon.AtlasPosition = Cursor;
+		Cursor.X += Icon.PixelSize.X + Padding;
+		ShelfHeight = FMath::Max(ShelfHeight, Icon.PixelSize.Y);
+		PageHeights.Last() = FMath::Max(PageHeights.Last(), Cursor.Y + ShelfHeight + Padding);
+	}
+
+	if (PageHeights[0] == 0)
+	{
+		return false;
+	}
+
+	Pages.Reset(PageHeights.Num());
+	TArray<uint8*> PagePixels;
+	PagePixels.Reserve(PageHeights.Num());
+
+	for (int32& PageHeight : PageHeights)
+	{
+		PageHeight = FMath::Min(static_cast<int32>(FMath::RoundUpToPowerOfTwo(PageHeight)), MaxDimension);
+
+		UTexture2D* Texture = UTexture2D::CreateTransient(PageWidth, PageHeight, PF_R8G8B8A8, TEXT("FancyFoldersIconAtlas"));
+		if (!Texture)
+		{
+			for (UTexture2D* Page : Pages)
+			{
+				Page->GetPlatformData()->Mips[0].BulkData.Unlock();
+			}
+
+			Pages.Reset();
+			return false;
+		}
+
+		Texture->SRGB = true;
+		Texture->Filter = TF_Bilinear;
+		Texture->LODGroup = TEXTUREGROUP_UI;
+
+		uint8* Pixels = static_cast<uint8*>(Texture->GetPlatformData()->Mips[0].BulkData.Lock(LOCK_READ_WRITE));
+		FMemory::Memzero(Pixels, PageWidth * PageHeight * 4);
+
+		Pages.Add(Texture);
+		PagePixels.Add(Pixels);
+	}
+
+	for (const FRasterizedIcon& Icon : Icons)
+	{
+		if (Icon.Page == INDEX_NONE)
+		{
+			continue;
+		}
+
+		for (int32 Row = 0; Row < Icon.PixelSize.Y; Row++)
+		{
+			uint8* Destination = PagePixels[Icon.Page] + ((Icon.AtlasPosition.Y + Row) * PageWidth + Icon.AtlasPosition.X) * 4;
+			const uint8* Source = Icon.Pixels.GetData() + Row * Icon.PixelSize.X * 4;
+			FMemory::Memcpy(Destination, Source, Icon.PixelSize.X * 4);
+		}
+	}
+
+	for (UTexture2D* Page : Pages)
+	{
+		Page->GetPlatformData()->Mips[0].BulkData.Unlock();
+		Page->UpdateResource();
+	}
+
+	Brushes.Reset();
+	Brushes.SetNum(IconFolders.Num() * NumFolderStates);
+
+	for (const FRasterizedIcon& Icon : Icons)
+	{
+		if (Icon.Page == INDEX_NONE)
+		{
+			continue;
+		}
+
+		const FVector2f PageSize(PageWidth, PageHeights[Icon.Page]);
+		const FVector2f UVMin = FVector2f(Icon.AtlasPosition) / PageSize;
+		const FVector2f UVMax = FVector2f(Icon.AtlasPosition + Icon.PixelSize) / PageSize;
+
+		TUniquePtr<FSlateBrush> Brush = MakeUnique<FSlateImageBrush>(Pages[Icon.Page].Get(), Icon.ImageSize);
+		Brush->SetUVRegion(FBox2f(UVMin, UVMax));
+		Brushes[Icon.BrushIndex] = MoveTemp(Brush);
+	}
+
+	return true;
+}
+
+const FSlateBrush* FFancyFoldersIconAtlas::GetBrush(int32 IconIndex, EFolderState State) const
+{
+	const int32 BrushIndex = IconIndex * NumFolderStates + static_cast<int32>(State);
+	return IconIndex != INDEX_NONE && Brushes.IsValidIndex(BrushIndex) ? Brushes[BrushIndex].Get() : nullptr;
+}
+
+void FFancyFoldersIconAtlas::AddReferencedObjects(FReferenceCollector& Collector)
+{
+	Collector.AddReferencedObjects(Pages);
+}
+
+FString FFancyFoldersIconAtlas::GetReferencerName() const
+{
+	return TEXT("FFancyFoldersIconAtlas");
+}
@@ -0,0 +1,911 @@
+﻿// Copyright Out-of-the-Box Plugins 2018-2025. All Rights Reserved.
+
+#include "FancyFoldersRules.h"
+
+#include <HAL/IConsoleManager.h>
+
+#include "FancyFolders.h"
+#include "FancyFoldersSettings.h"
+#include "FancyFoldersStats.h"
+
+DECLARE_CYCLE_STAT(TEXT("Resolve Rules"), STAT_FancyFolders_ResolveRules, STATGROUP_FancyFolders);
+
+static TAutoConsoleVariable<bool> CVarVerifyPatterns(
+	TEXT("FancyFolders.VerifyPatterns"),
+	false,
+	TEXT("Evaluates every simplified preset pattern with ICU as well and reports any difference"),
+	ECVF_Default
+);
+
+FFancyFoldersPattern::FFancyFoldersPattern(const FString& InPattern) : Regex(InPattern)
+{
+	if (!Classify(InPattern))
+	{
+		Kind = EFancyFoldersPatternKind::Regex;
+		Segments.Reset();
+	}
+}
+
+bool FFancyFoldersPattern::Matches(const FString& Subject) const
+{
+	if (Kind == EFancyFoldersPatternKind::Regex)
+	{
+		return MatchesRegex(Subject);
+	}
+
+	const bool bMatches = MatchesLiterals(Subject);
+
+	if (CVarVerifyPatterns.GetValueOnAnyThread())
+	{
+		const bool bRegexMatches = MatchesRegex(Subject);
+		UE_CLOG(bMatches != bRegexMatches, LogFancyFolders, Error, TEXT("Pattern '%s' matches '%s': %s, but ICU says %s"), *Regex.GetPatternString(), *Subject, bMatches ? TEXT("true") : TEXT("false"), bRegexMatches ? TEXT("true") : TEXT("false"));
+	}
+
+	return bMatches;
+}
+
+bool FFancyFoldersPattern::MatchesRegex(const FString& Subject) const
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FFancyFoldersPattern::MatchesRegex)
+
+	FancyFolders::Stats::Add(FancyFolders::Stats::ECounter::RegexEvaluations);
+
+	return FRegexMatcher(Regex, Subject).FindNext();
+}
+
+bool FFancyFoldersPattern::Classify(const FString& InPattern)
+{
+	int32 Begin = 0;
+	int32 End = InPattern.Len();
+
+	bAnchoredStart = End > 0 && InPattern[0] == TEXT('^');
+	if (bAnchoredStart)
+	{
+		Begin++;
+	}
+
+	// A trailing $ is only an anchor if it isn't escaped, i.e. preceded by an even number of backslashes
+	if (End > Begin && InPattern[End - 1] == TEXT('$'))
+	{
+		int32 Backslashes = 0;
+		while (End - 2 - Backslashes >= Begin && InPattern[End - 2 - Backslashes] == TEXT('\\'))
+		{
+			Backslashes++;
+		}
+
+		bAnchoredEnd = Backslashes % 2 == 0;
+		if (bAnchoredEnd)
+		{
+			End--;
+		}
+	}
+
+	Segments.Reset();
+	Segments.AddDefaulted();
+
+	for (int32 Index = Begin; Index < End; Index++)
+	{
+		const TCHAR Char = InPattern[Index];
+		switch (Char)
+		{
+		case TEXT('\\'):
+			// Escaped punctuation is a literal, escaped letters & digits are classes, anchors or back references
+			if (Index + 1 >= End || FChar::IsAlnum(InPattern[Index + 1]))
+			{
+				return false;
+			}
+			Segments.Last().AppendChar(InPattern[++Index]);
+			break;
+		case TEXT('.'):
+			// Only the .* wildcard is supported, a single . is any character
+			if (Index + 1 >= End || InPattern[Index + 1] != TEXT('*'))
+			{
+				return false;
+			}
+			Segments.AddDefaulted();
+			Index++;
+			break;
+		case TEXT('*'):
+			// Repeating the last character zero or more times, e.g. BP_*, is the same as leaving it out, as long as nothing has to follow it
+			if (Index + 1 != End || bAnchoredEnd || Segments.Last().IsEmpty())
+			{
+				return false;
+			}
+			Segments.Last().LeftChopInline(1, EAllowShrinking::No);
+			break;
+		case TEXT('^'):
+		case TEXT('$'):
+		case TEXT('|'):
+		case TEXT('?'):
+		case TEXT('+'):
+		case TEXT('('):
+		case TEXT(')'):
+		case TEXT('['):
+		case TEXT(']'):
+		case TEXT('{'):
+		case TEXT('}'):
+			return false;
+		default:
+			Segments.Last().AppendChar(Char);
+			break;
+		}
+	}
+
+	// A wildcard at either end removes the anchor on that side
+	if (Segments.Num() > 1 && Segments[0].IsEmpty())
+	{
+		bAnchoredStart = false;
+	}
+
+	if (Segments.Num() > 1 && Segments.Last().IsEmpty())
+	{
+		bAnchoredEnd = false;
+	}
+
+	if (Segments.Num() > 1)
+	{
+		Segments.RemoveAll(
+			[](const FString& Segment)
+			{
+				return Segment.IsEmpty();
+			}
+		);
+	}
+
+	if (Segments.IsEmpty())
+	{
+		// Nothing but wildcards, matches everything
+		Segments.AddDefaulted();
+	}
+
+	if (Segments.Num() > 1)
+	{
+		Kind = EFancyFoldersPatternKind::Glob;
+	}
+	else if (bAnchoredStart && bAnchoredEnd)
+	{
+		Kind = EFancyFoldersPatternKind::Exact;
+	}
+	else if (bAnchoredStart)
+	{
+		Kind = EFancyFoldersPatternKind::Prefix;
+	}
+	else if (bAnchoredEnd)
+	{
+		Kind = EFancyFoldersPatternKind::Suffix;
+	}
+	else
+	{
+		Kind = EFancyFoldersPatternKind::Contains;
+	}
+
+	return true;
+}
+
+bool FFancyFoldersPattern::MatchesLiterals(const FString& Subject) const
+{
+	// An empty literal which doesn't have to span the whole subject is found in any subject
+	if (Kind != EFancyFoldersPatternKind::Exact && Segments.Num() == 1 && Segments[0].IsEmpty())
+	{
+		return true;
+	}
+
+	switch (Kind)
+	{
+	case EFancyFoldersPatternKind::Exact:
+		return Subject.Equals(Segments[0], ESearchCase::CaseSensitive);
+	case EFancyFoldersPatternKind::Prefix:
+		return Subject.StartsWith(Segments[0], ESearchCase::CaseSensitive);
+	case EFancyFoldersPatternKind::Suffix:
+		return Subject.EndsWith(Segments[0], ESearchCase::CaseSensitive);
+	case EFancyFoldersPatternKind::Contains:
+		return Subject.Contains(Segments[0], ESearchCase::CaseSensitive);
+	case EFancyFoldersPatternKind::Glob:
+		break;
+	default:
+		checkNoEntry();
+		return false;
+	}
+
+	int32 First = 0;
+	int32 Last = Segments.Num() - 1;
+	int32 Cursor = 0;
+	int32 Limit = Subject.Len();
+
+	if (bAnchoredStart)
+	{
+		if (!Subject.StartsWith(Segments[First], ESearchCase::CaseSensitive))
+		{
+			return false;
+		}
+		Cursor = Segments[First++].Len();
+	}
+
+	if (bAnchoredEnd)
+	{
+		if (!Subject.EndsWith(Segments[Last], ESearchCase::CaseSensitive))
+		{
+			return false;
+		}
+		Limit -= Segments[Last--].Len();
+	}
+
+	// The leftmost occurrence of each segment leaves the most room for the following ones
+	for (int32 Index = First; Index <= Last; Index++)
+	{
+		const int32 Found = Subject.Find(Segments[Index], ESearchCase::CaseSensitive, ESearchDir::FromStart, Cursor);
+		if (Found == INDEX_NONE)
+		{
+			return false;
+		}
+		Cursor = Found + Segments[Index].Len();
+	}
+
+	return Cursor <= Limit;
+}
+
+void FFancyFoldersPatternList::Build(TConstArrayView<FString> InPatterns)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FFancyFoldersPatternList::Build)
+
+	Patterns.Reset(InPatterns.Num());
+	DirectPatterns.Reset();
+	Nodes.Reset();
+	Nodes.AddDefaulted();
+
+	for (int32 PatternIndex = 0; PatternIndex < InPatterns.Num(); PatternIndex++)
+	{
+		const FFancyFoldersPattern& Pattern = Patterns.Emplace_GetRef(InPatterns[PatternIndex]);
+		if (Pattern.GetKind() == EFancyFoldersPatternKind::Regex)
+		{
+			DirectPatterns.Add(PatternIndex);
+			continue;
+		}
+
+		// Globs only need one of their literals to be found to become a candidate, the longest one filters the best
+		const FString* Literal = &Pattern.GetSegments()[0];
+		for (const FString& Segment : Pattern.GetSegments())
+		{
+			if (Segment.Len() > Literal->Len())
+			{
+				Literal = &Segment;
+			}
+		}
+
+		if (Literal->IsEmpty())
+		{
+			DirectPatterns.Add(PatternIndex);
+			continue;
+		}
+
+		int32 State = 0;
+		for (const TCHAR Char : *Literal)
+		{
+			if (const int32* Next = Nodes[State].Next.Find(Char))
+			{
+				State = *Next;
+				continue;
+			}
+
+			const int32 NewState = Nodes.AddDefaulted();
+			Nodes[NewState].Depth = Nodes[State].Depth + 1;
+			Nodes[State].Next.Add(Char, NewState);
+			State = NewState;
+		}
+
+		Nodes[State].Outputs.Add(PatternIndex);
+	}
+
+	// Breadth first, so the fail state of a node is always complete before it's children are processed
+	TArray<int32> Queue;
+	Queue.Reserve(Nodes.Num());
+	for (const TPair<TCHAR, int32>& Child : Nodes[0].Next)
+	{
+		Queue.Add(Child.Value);
+	}
+
+	for (int32 QueueIndex = 0; QueueIndex < Queue.Num(); QueueIndex++)
+	{
+		const int32 State = Queue[QueueIndex];
+		for (const TPair<TCHAR, int32>& Child : Nodes[State].Next)
+		{
+			int32 Fail = Nodes[State].Fail;
+			const int32* Next = Nodes[Fail].Next.Find(Child.Key);
+			while (!Next && Fail != 0)
+			{
+				Fail = Nodes[Fail].Fail;
+				Next = Nodes[Fail].Next.Find(Child.Key);
+			}
+
+			FNode& ChildNode = Nodes[Child.Value];
+			ChildNode.Fail = Next ? *Next : 0;
+			ChildNode.OutputLink = Nodes[ChildNode.Fail].Outputs.IsEmpty() ? Nodes[ChildNode.Fail].OutputLink : ChildNode.Fail;
+			Queue.Add(Child.Value);
+		}
+	}
+}
+
+int32 FFancyFoldersPatternList::FindFirstMatch(const FString& Subject) const
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FFancyFoldersPatternList::FindFirstMatch)
+
+	int32 BestMatch = MAX_int32;
+	TArray<int32, TInlineAllocator<16>> Candidates;
+
+	if (Nodes.Num() > 1)
+	{
+		int32 State = 0;
+		for (int32 Position = 0; Position < Subject.Len(); Position++)
+		{
+			const TCHAR Char = Subject[Position];
+			const int32* Next = Nodes[State].Next.Find(Char);
+			while (!Next && State != 0)
+			{
+				State = Nodes[State].Fail;
+				Next = Nodes[State].Next.Find(Char);
+			}
+			State = Next ? *Next : 0;
+
+			for (int32 OutputState = Nodes[State].Outputs.IsEmpty() ? Nodes[State].OutputLink : State; OutputState != INDEX_NONE; OutputState = Nodes[OutputState].OutputLink)
+			{
+				const FNode& Output = Nodes[OutputState];
+				const bool bAtStart = Position + 1 == Output.Depth;
+				const bool bAtEnd = Position + 1 == Subject.Len();
+
+				for (const int32 PatternIndex : Output.Outputs)
+				{
+					// Outputs are sorted, none of the following ones can beat the best match either
+					if (PatternIndex >= BestMatch)
+					{
+						break;
+					}
+
+					bool bMatches = false;
+					switch (Patterns[PatternIndex].GetKind())
+					{
+					case EFancyFoldersPatternKind::Exact:
+						bMatches = bAtStart && bAtEnd;
+						break;
+					case EFancyFoldersPatternKind::Prefix:
+						bMatches = bAtStart;
+						break;
+					case EFancyFoldersPatternKind::Suffix:
+						bMatches = bAtEnd;
+						break;
+					case EFancyFoldersPatternKind::Contains:
+						bMatches = true;
+						break;
+					default:
+						Candidates.AddUnique(PatternIndex);
+						break;
+					}
+
+					if (bMatches)
+					{
+						BestMatch = PatternIndex;
+						break;
+					}
+				}
+			}
+		}
+	}
+
+	// Candidates and direct patterns are only evaluated if they would beat the best match, lowest index first
+	Candidates.Sort();
+
+	int32 CandidateIndex = 0;
+	int32 DirectIndex = 0;
+	while (true)
+	{
+		const int32 Candidate = Candidates.IsValidIndex(CandidateIndex) ? Candidates[CandidateIndex] : MAX_int32;
+		const int32 Direct = DirectPatterns.IsValidIndex(DirectIndex) ? DirectPatterns[DirectIndex] : MAX_int32;
+		const int32 PatternIndex = FMath::Min(Candidate, Direct);
+		if (PatternIndex >= BestMatch)
+		{
+			break;
+		}
+
+		if (Patterns[PatternIndex].Matches(Subject))
+		{
+			BestMatch = PatternIndex;
+			break;
+		}
+
+		if (Candidate < Direct)
+		{
+			CandidateIndex++;
+		}
+		else
+		{
+			DirectIndex++;
+		}
+	}
+
+	return BestMatch == MAX_int32 ? INDEX_NONE : BestMatch;
+}
+
+void FCompactPathAssignments::Reset(int32 ExpectedNum)
+{
+	PathIndices.Reset();
+	PathIndices.Reserve(ExpectedNum);
+	Paths.Reset(ExpectedNum);
+	IconIndices.Reset(ExpectedNum);
+	ColorIndices.Reset(ExpectedNum);
+	ApplyToSubfolders.Empty(ExpectedNum);
+	Removed.Empty(ExpectedNum);
+	NumRemoved = 0;
+	NumShadowed = 0;
+	IconPalette.Reset();
+	IconPaletteIndices.Reset();
+	ColorPalette.Reset();
+	ColorPaletteIndices.Reset();
+}
+
+bool FCompactPathAssignments::Add(const FString& Path, const FFolderData& Data, bool bApplyToSubfolders)
+{
+	const FName PathName(*Path);
+
+	const bool bShadowed = PathIndices.Contains(PathName);
+	if (bShadowed)
+	{
+		NumShadowed++;
+	}
+	else
+	{
+		PathIndices.Add(PathName, Paths.Num());
+	}
+
+	Paths.Add(PathName);
+	IconIndices.Add(FindOrAddIcon(Data.Icon));
+	ColorIndices.Add(FindOrAddColor(Data.Color));
+	ApplyToSubfolders.Add(bApplyToSubfolders);
+	Removed.Add(false);
+
+	return !bShadowed;
+}
+
+bool FCompactPathAssignments::Contains(const FString& Path) const
+{
+	// Paths which were never turned into a name can't have an assignment, no need to add them to the name table
+	const FName PathName(*Path, FNAME_Find);
+	return !PathName.IsNone() && PathIndices.Contains(PathName);
+}
+
+TOptional<FFolderData> FCompactPathAssignments::Find(const FString& Path, bool* bOutApplyToSubfolders) const
+{
+	const FName PathName(*Path, FNAME_Find);
+	if (PathName.IsNone())
+	{
+		return {};
+	}
+
+	const int32* Index = PathIndices.Find(PathName);
+	if (!Index)
+	{
+		return {};
+	}
+
+	if (bOutApplyToSubfolders)
+	{
+		*bOutApplyToSubfolders = ApplyToSubfolders[*Index];
+	}
+
+	return FFolderData(IconPalette[IconIndices[*Index]], ColorPalette[ColorIndices[*Index]]);
+}
+
+void FCompactPathAssignments::Set(const FString& Path, const FFolderData& Data, bool bApplyToSubfolders)
+{
+	const int32* Index = PathIndices.Find(FName(*Path));
+	if (!Index)
+	{
+		Add(Path, Data, bApplyToSubfolders);
+		return;
+	}
+
+	IconIndices[*Index] = FindOrAddIcon(Data.Icon);
+	ColorIndices[*Index] = FindOrAddColor(Data.Color);
+	ApplyToSubfolders[*Index] = bApplyToSubfolders;
+}
+
+bool FCompactPathAssignments::Remove(const FString& Path)
+{
+	const FName PathName(*Path, FNAME_Find);
+
+	int32 Index;
+	if (PathName.IsNone() || !PathIndices.RemoveAndCopyValue(PathName, Index))
+	{
+		return false;
+	}
+
+	// The entry is only flagged, shifting all the arrays (and re-indexing the paths after it) on every removal would be linear
+	Removed[Index] = true;
+	NumRemoved++;
+
+	// Any duplicate of the path comes after the removed entry, the next one takes over
+	if (NumShadowed > 0)
+	{
+		for (int32 NextIndex = Index + 1; NextIndex < Paths.Num(); NextIndex++)
+		{
+			if (!Removed[NextIndex] && Paths[NextIndex] == PathName)
+			{
+				PathIndices.Add(PathName, NextIndex);
+				NumShadowed--;
+				break;
+			}
+		}
+	}
+
+	if (NumRemoved > Paths.Num() / 2)
+	{
+		Compact();
+	}
+
+	return true;
+}
+
+int32 FCompactPathAssignments::IndexOf(const FString& Path) const
+{
+	const FName PathName(*Path, FNAME_Find);
+	const int32* Index = PathName.IsNone() ? nullptr : PathIndices.Find(PathName);
+	if (!Index)
+	{
+		return INDEX_NONE;
+	}
+
+	// Removed entries are still in the parallel arrays, but not in the original order anymore
+	return NumRemoved > 0 ? *Index - Removed.CountSetBits(0, *Index) : *Index;
+}
+
+void FCompactPathAssignments::ToArray(TArray<FPathAssignedData>& OutAssignments) const
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FCompactPathAssignments::ToArray)
+
+	OutAssignments.Reset(Paths.Num() - NumRemoved);
+	for (int32 Index = 0; Index < Paths.Num(); Index++)
+	{
+		if (!Removed[Index])
+		{
+			OutAssignments.Add({Paths[Index].ToString(), FFolderData(IconPalette[IconIndices[Index]], ColorPalette[ColorIndices[Index]]), ApplyToSubfolders[Index]});
+		}
+	}
+}
+
+uint16 FCompactPathAssignments::FindOrAddIcon(const FName& Icon)
+{
+	if (const uint16* IconIndex = IconPaletteIndices.Find(Icon))
+	{
+		return *IconIndex;
+	}
+
+	checkf(IconPalette.Num() < MAX_uint16, TEXT("Too many distinct icons used by the FancyFolders path assignments"));
+
+	const uint16 IconIndex = static_cast<uint16>(IconPalette.Add(Icon));
+	IconPaletteIndices.Add(Icon, IconIndex);
+	return IconIndex;
+}
+
+uint32 FCompactPathAssignments::FindOrAddColor(const FLinearColor& Color)
+{
+	if (const uint32* ColorIndex = ColorPaletteIndices.Find(Color))
+	{
+		return *ColorIndex;
+	}
+
+	const uint32 ColorIndex = static_cast<uint32>(ColorPalette.Add(Color));
+	ColorPaletteIndices.Add(Color, ColorIndex);
+	return ColorIndex;
+}
+
+void FCompactPathAssignments::Compact()
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FCompactPathAssignments::Compact)
+
+	// Rebuilding from scratch also drops the palette entries nothing uses anymore
+	TArray<FPathAssignedData> Assignments;
+	ToArray(Assignments);
+
+	Reset(Assignments.Num());
+	for (const FPathAssignedData& Assignment : Assignments)
+	{
+		Add(Assignment.Path, Assignment.Data, Assignment.bApplyToSubfolders);
+	}
+}
+
+namespace RulesHelpers
+{
+	/**
+	 * Calls the visitor with each component of a path, e.g.: /Game/Maps -> Game, Maps. Stops early if the visitor returns false
+	 */
+	template <typename FVisitor>
+	void ForEachPathComponent(FStringView Path, FVisitor&& Visitor)
+	{
+		int32 Start = 0;
+		while (Start < Path.Len())
+		{
+			int32 End = Start;
+			while (End < Path.Len() && Path[End] != TEXT('/'))
+			{
+				End++;
+			}
+
+			if (End > Start && !Visitor(Path.Mid(Start, End - Start)))
+			{
+				return;
+			}
+
+			Start = End + 1;
+		}
+	}
+} // namespace RulesHelpers
+
+void FInheritedPathTrie::Reset()
+{
+	Children.Reset();
+	NodeData.Reset();
+	NumEntries = 0;
+}
+
+void FInheritedPathTrie::Set(const FString& Path, const FFolderData& Data)
+{
+	TOptional<FFolderData>& Entry = NodeData[FindNode(Path, true)];
+	if (!Entry)
+	{
+		NumEntries++;
+	}
+
+	Entry = Data;
+}
+
+bool FInheritedPathTrie::Remove(const FString& Path)
+{
+	// Nodes themselves are kept, they are dropped the next time the rule set is built
+	const int32 Node = FindNode(Path, false);
+	if (Node == INDEX_NONE || !NodeData[Node])
+	{
+		return false;
+	}
+
+	NodeData[Node].Reset();
+	NumEntries--;
+	return true;
+}
+
+TOptional<FFolderData> FInheritedPathTrie::FindNearestParent(const FString& Path, int32* OutParentLength) const
+{
+	if (NumEntries == 0)
+	{
+		return {};
+	}
+
+	int32 LastSlash = INDEX_NONE;
+	Path.FindLastChar(TEXT('/'), LastSlash);
+	if (LastSlash == INDEX_NONE)
+	{
+		return {};
+	}
+
+	// Walks down the parent path, each deeper match overrides the previous one
+	TOptional<FFolderData> Result = NodeData[0];
+	int32 ParentLength = 0;
+	int32 Node = 0;
+	RulesHelpers::ForEachPathComponent(FStringView(Path).Left(LastSlash),
+		[this, &Path, &Node, &Result, &ParentLength](FStringView Component)
+		{
+			// Components which were never turned into a name can't be part of the trie
+			const FName ComponentName(Component.Len(), Component.GetData(), FNAME_Find);
+			const int32* Child = ComponentName.IsNone() ? nullptr : Children.Find({Node, ComponentName});
+			if (!Child)
+			{
+				return false;
+			}
+
+			Node = *Child;
+			if (NodeData[Node])
+			{
+				Result = NodeData[Node];
+				ParentLength = UE_PTRDIFF_TO_INT32(Component.GetData() + Component.Len() - *Path);
+			}
+
+			return true;
+		}
+	);
+
+	if (OutParentLength)
+	{
+		*OutParentLength = ParentLength;
+	}
+
+	return Result;
+}
+
+int32 FInheritedPathTrie::FindNode(FStringView Path, bool bCreate)
+{
+	if (NodeData.IsEmpty())
+	{
+		if (!bCreate)
+		{
+			return INDEX_NONE;
+		}
+
+		NodeData.AddDefaulted();
+	}
+
+	int32 Node = 0;
+	RulesHelpers::ForEachPathComponent(Path,
+		[this, &Node, bCreate](FStringView Component)
+		{
+			const FName ComponentName(Component.Len(), Component.GetData(), bCreate ? FNAME_Add : FNAME_Find);
+			if (ComponentName.IsNone())
+			{
+				Node = INDEX_NONE;
+				return false;
+			}
+
+			if (const int32* Child = Children.Find({Node, ComponentName}))
+			{
+				Node = *Child;
+				return true;
+			}
+
+			if (!bCreate)
+			{
+				Node = INDEX_NONE;
+				return false;
+			}
+
+			const int32 NewNode = NodeData.AddDefaulted();
+			Children.Add({Node, ComponentName}, NewNode);
+			Node = NewNode;
+			return true;
+		}
+	);
+
+	return Node;
+}
+
+void FFancyFoldersRuleSet::BuildAssignments(const TArray<FPathAssignedData>& InPathAssignments)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FFancyFoldersRuleSet::BuildAssignments)
+
+	Assignments.Reset(InPathAssignments.Num());
+	InheritedAssignments.Reset();
+	for (const FPathAssignedData& PathAssigned : InPathAssignments)
+	{
+		// In case of duplicates the first assignment wins, same as a linear search would. The others are still kept so the config file round trips
+		if (!Assignments.Add(PathAssigned.Path, PathAssigned.Data, PathAssigned.bApplyToSubfolders))
+		{
+			UE_LOG(LogFancyFolders, Warning, TEXT("Path '%s' is assigned more than once, only its first assignment is used"), *PathAssigned.Path);
+			continue;
+		}
+
+		if (PathAssigned.bApplyToSubfolders)
+		{
+			InheritedAssignments.Set(PathAssigned.Path, PathAssigned.Data);
+		}
+	}
+
+	Generation++;
+}
+
+void FFancyFoldersRuleSet::BuildPresets(const TArray<FPathPresetData>& InPathPresets, const TArray<FFolderPresetData>& InFolderPresets)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FFancyFoldersRuleSet::BuildPresets)
+
+	TArray<FString> PatternStrings;
+	PatternStrings.Reserve(FMath::Max(InFolderPresets.Num(), InPathPresets.Num()));
+
+	FolderPresetData.Reset(InFolderPresets.Num());
+	for (const FFolderPresetData& FolderPreset : InFolderPresets)
+	{
+		PatternStrings.Add(FolderPreset.FolderRegex);
+		FolderPresetData.Add(FolderPreset.Data);
+	}
+	FolderPatterns.Build(PatternStrings);
+
+	PatternStrings.Reset();
+	PathPresetData.Reset(InPathPresets.Num());
+	for (const FPathPresetData& PathPreset : InPathPresets)
+	{
+		PatternStrings.Add(PathPreset.PathRegex);
+		PathPresetData.Add(PathPreset.Data);
+	}
+	PathPatterns.Build(PatternStrings);
+
+	Generation++;
+}
+
+TOptional<FFolderData> FFancyFoldersRuleSet::Resolve(const FString& Path, FFancyFoldersRuleMatch* OutMatch) const
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FFancyFoldersRuleSet::Resolve)
+	SCOPE_CYCLE_COUNTER(STAT_FancyFolders_ResolveRules);
+
+	FancyFolders::Stats::Add(FancyFolders::Stats::ECounter::RulesResolved);
+
+	FFancyFoldersRuleMatch LocalMatch;
+	FFancyFoldersRuleMatch& Match = OutMatch ? *OutMatch : LocalMatch;
+	Match = {};
+
+	if (TOptional<FFolderData> Assignment = Assignments.Find(Path))
+	{
+		Match.Kind = EFancyFoldersRuleKind::Assignment;
+		Match.AssignedPathLength = Path.Len();
+		return Assignment;
+	}
+
+	if (TOptional<FFolderData> InheritedAssignment = InheritedAssignments.FindNearestParent(Path, &Match.AssignedPathLength))
+	{
+		Match.Kind = EFancyFoldersRuleKind::InheritedAssignment;
+		return InheritedAssignment;
+	}
+
+	if (FolderPatterns.Num() > 0)
+	{
+		const FString FolderName = FPaths::GetBaseFilename(Path);
+		const int32 FolderPresetIndex = FolderPatterns.FindFirstMatch(FolderName);
+		if (FolderPresetIndex != INDEX_NONE)
+		{
+			Match.Kind = EFancyFoldersRuleKind::FolderPreset;
+			Match.PresetIndex = FolderPresetIndex;
+			return FolderPresetData[FolderPresetIndex];
+		}
+	}
+
+	if (PathPatterns.Num() > 0)
+	{
+		const int32 PathPresetIndex = PathPatterns.FindFirstMatch(Path);
+		if (PathPresetIndex != INDEX_NONE)
+		{
+			Match.Kind = EFancyFoldersRuleKind::PathPreset;
+			Match.PresetIndex = PathPresetIndex;
+			return PathPresetData[PathPresetIndex];
+		}
+	}
+
+	return {};
+}
+
+TOptional<FFolderData> FFancyFoldersRuleSet::FindAssignment(const FString& Path, bool* bOutApplyToSubfolders) const
+{
+	return Assignments.Find(Path, bOutApplyToSubfolders);
+}
+
+int32 FFancyFoldersRuleSet::FindAssignmentIndex(const FString& Path) const
+{
+	return Assignments.IndexOf(Path);
+}
+
+void FFancyFoldersRuleSet::SetAssignment(const FString& Path, const FFolderData& Data, bool bApplyToSubfolders)
+{
+	Assignments.Set(Path, Data, bApplyToSubfolders);
+
+	if (bApplyToSubfolders)
+	{
+		InheritedAssignments.Set(Path, Data);
+	}
+	else
+	{
+		InheritedAssignments.Remove(Path);
+	}
+
+	Generation++;
+}
+
+void FFancyFoldersRuleSet::RemoveAssignment(const FString& Path)
+{
+	InheritedAssignments.Remove(Path);
+
+	if (!Assignments.Remove(Path))
+	{
+		return;
+	}
+
+	// A duplicate of the path may have taken over
+	bool bApplyToSubfolders = false;
+	const TOptional<FFolderData> Duplicate = Assignments.Find(Path, &bApplyToSubfolders);
+	if (Duplicate && bApplyToSubfolders)
+	{
+		InheritedAssignments.Set(Path, *Duplicate);
+	}
+
+	Generation++;
+}
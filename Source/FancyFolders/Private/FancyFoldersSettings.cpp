@@ -4,49 +4,39 @@
 
 #include <AssetViewUtils.h>
 
-EFolderState StateFromFlags(bool bIsColumnView, bool bIsOpen)
+#include "FancyFolders.h"
+#include "FancyFoldersStyle.h"
+
+bool FResolvedFolderData::ResolveIconIndex()
 {
-	if (bIsColumnView)
+	if (!Data)
 	{
-		return bIsOpen ? EFolderState::ColumnOpen : EFolderState::ColumnClosed;
+		return false;
 	}
 
-	return EFolderState::Normal;
+	const FFancyFoldersStyle& Style = FFancyFoldersStyle::Get();
+	if (IconTableVersion == Style.GetIconTableVersion())
+	{
+		return false;
+	}
+
+	IconIndex = Style.FindIconIndex(Data->Icon);
+	IconTableVersion = Style.GetIconTableVersion();
+	return true;
 }
 
 TOptional<FFolderData> UFancyFoldersSettings::GetDataForPath(const FString& Path) const
 {
 	TRACE_CPUPROFILER_EVENT_SCOPE(UFancyFoldersSettings::GetDataForPath)
 
-	for (const auto& PathAssigned : PathAssignments)
-	{
-		if (PathAssigned.Path == Path)
-		{
-			return PathAssigned.Data;
-		}
-	}
-
-	for (const auto& FolderPreset : FolderPresets)
-	{
-		const FString FolderName = FPaths::GetBaseFilename(Path);
-
-		const FRegexPattern FolderPattern(FolderPreset.FolderRegex);
-		if (FRegexMatcher(FolderPattern, FolderName).FindNext())
-		{
-			return FolderPreset.Data;
-		}
-	}
+	return FindOrResolveData(Path).Data;
+}
 
-	for (const auto& PathPreset : PathPresets)
-	{
-		const FRegexPattern FolderPattern(PathPreset.PathRegex);
-		if (FRegexMatcher(FolderPattern, Path).FindNext())
-		{
-			return PathPreset.Data;
-		}
-	}
+FResolvedFolderData UFancyFoldersSettings::GetResolvedDataForPath(const FString& Path) const
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(UFancyFoldersSettings::GetResolvedDataForPath)
 
-	return {};
+	return FindOrResolveData(Path);
 }
 
 TOptional<FLinearColor> UFancyFoldersSettings::GetColorForPath(const FString& Path) const
@@ -66,88 +56,184 @@ const FSlateBrush* UFancyFoldersSettings::GetIconForPath(const FString& Path, bo
 {
 	TRACE_CPUPROFILER_EVENT_SCOPE(UFancyFoldersSettings::GetIconForPath)
 
-	const TOptional<FFolderData> DataForPath = GetDataForPath(Path);
-	if (!DataForPath)
+	FResolvedFolderData ResolvedData = FindOrResolveData(Path);
+	if (!ResolvedData.Data)
 	{
 		return nullptr;
 	}
 
+	// The icon index is only looked up by the callers drawing the icon, data queries never need the style
+	if (ResolvedData.ResolveIconIndex())
+	{
+		ResolvedDataCache.Add(Path, ResolvedData);
+	}
+
 	const EFolderState FolderState = StateFromFlags(bIsColumnView, bIsOpen);
-	return DataForPath.GetValue().GetIcon(FolderState);
+	return FFancyFoldersStyle::Get().GetFolderBrush(ResolvedData.IconIndex, FolderState);
 }
 
 void UFancyFoldersSettings::UpdateOrCreateAssignmentIcon(const FString& Path, TOptional<FName> Icon)
 {
 	TRACE_CPUPROFILER_EVENT_SCOPE(UFancyFoldersSettings::UpdateOrCreateAssignmentIcon)
 
-	auto FindEntryPredicate = [Path](const FPathAssignedData& Data)
-	{
-		return Data.Path == Path;
-	};
-
-	FPathAssignedData* CurrentAssignment = PathAssignments.FindByPredicate(FindEntryPredicate);
+	bool bApplyToSubfolders = false;
+	TOptional<FFolderData> CurrentData = Rules.FindAssignment(Path, &bApplyToSubfolders);
 	if (Icon.IsSet())
 	{
-		if (CurrentAssignment)
+		if (CurrentData)
 		{
-			CurrentAssignment->Data.Icon = *Icon;
+			CurrentData->Icon = *Icon;
+			SetAssignment(Path, *CurrentData, bApplyToSubfolders);
 		}
 		else
 		{
-			FPathAssignedData NewAssignment = {Path, {*Icon, AssetViewUtils::GetDefaultColor()}};
-			PathAssignments.Emplace(NewAssignment);
+			SetAssignment(Path, {*Icon, AssetViewUtils::GetDefaultColor()});
 		}
 	}
 	else
 	{
-		if (CurrentAssignment && !CurrentAssignment->Data.Color.Equals(AssetViewUtils::GetDefaultColor(), 0.1f))
+		if (CurrentData && !CurrentData->Color.Equals(AssetViewUtils::GetDefaultColor(), 0.1f))
 		{
-			CurrentAssignment->Data.Icon = FName("Default");
+			CurrentData->Icon = FName("Default");
+			SetAssignment(Path, *CurrentData, bApplyToSubfolders);
 		}
 		else
 		{
-			PathAssignments.RemoveAll(FindEntryPredicate);
+			RemoveAssignment(Path);
 		}
 	}
 
-	TryUpdateDefaultConfigFile();
+	MarkConfigDirty();
 }
 
 void UFancyFoldersSettings::UpdateOrCreateAssignmentColor(const FString& Path, TOptional<FLinearColor> Color)
 {
 	TRACE_CPUPROFILER_EVENT_SCOPE(UFancyFoldersSettings::UpdateOrCreateAssignmentColor)
 
-	auto FindEntryPredicate = [Path](const FPathAssignedData& Data)
-	{
-		return Data.Path == Path;
-	};
-
-	FPathAssignedData* CurrentAssignment = PathAssignments.FindByPredicate(FindEntryPredicate);
+	bool bApplyToSubfolders = false;
+	TOptional<FFolderData> CurrentData = Rules.FindAssignment(Path, &bApplyToSubfolders);
 	if (Color.IsSet())
 	{
-		if (CurrentAssignment)
+		if (CurrentData)
 		{
-			CurrentAssignment->Data.Color = *Color;
+			CurrentData->Color = *Color;
+			SetAssignment(Path, *CurrentData, bApplyToSubfolders);
 		}
 		else
 		{
-			FPathAssignedData NewAssignment = {Path, {FName("Default"), *Color}};
-			PathAssignments.Emplace(NewAssignment);
+			SetAssignment(Path, {FName("Default"), *Color});
 		}
 	}
 	else
 	{
-		if (CurrentAssignment && CurrentAssignment->Data.Icon != FName("Default"))
+		if (CurrentData && CurrentData->Icon != FName("Default"))
 		{
-			CurrentAssignment->Data.Color = Color.GetValue();
+			CurrentData->Color = AssetViewUtils::GetDefaultColor();
+			SetAssignment(Path, *CurrentData, bApplyToSubfolders);
 		}
 		else
 		{
-			PathAssignments.RemoveAll(FindEntryPredicate);
+			RemoveAssignment(Path);
 		}
 	}
 
-	TryUpdateDefaultConfigFile();
+	MarkConfigDirty();
+}
+
+void UFancyFoldersSettings::UpdateOrCreateAssignment(const FString& Path, const FFolderData& Data)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(UFancyFoldersSettings::UpdateOrCreateAssignment)
+
+	bool bApplyToSubfolders = false;
+	Rules.FindAssignment(Path, &bApplyToSubfolders);
+	SetAssignment(Path, Data, bApplyToSubfolders);
+
+	MarkConfigDirty();
+}
+
+double UFancyFoldersSettings::GetRefreshTimeBudget() const
+{
+	return RefreshTimeBudget / 1000.0;
+}
+
+bool UFancyFoldersSettings::UseIconAtlas() const
+{
+	return bUseIconAtlas;
+}
+
+double UFancyFoldersSettings::GetRefreshInterval(bool bEditorFocused) const
+{
+	const float RefreshRate = bEditorFocused ? MaxRefreshRate : UnfocusedRefreshRate;
+	return RefreshRate > 0.0f ? 1.0 / RefreshRate : TNumericLimits<double>::Max();
+}
+
+bool UFancyFoldersSettings::RefreshWhileUnfocused() const
+{
+	return UnfocusedRefreshRate > 0.0f;
+}
+
+bool UFancyFoldersSettings::SuspendDuringPIE() const
+{
+	return bSuspendDuringPIE;
+}
+
+uint32 UFancyFoldersSettings::GetRulesGeneration() const
+{
+	return Rules.GetGeneration();
+}
+
+FFancyFoldersCacheStats UFancyFoldersSettings::GetCacheStats() const
+{
+	FFancyFoldersCacheStats Result = CacheStats;
+	Result.Num = ResolvedDataCache.Num();
+	return Result;
+}
+
+void UFancyFoldersSettings::ResetCacheStats()
+{
+	CacheStats = {};
+}
+
+void UFancyFoldersSettings::FlushConfig()
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(UFancyFoldersSettings::FlushConfig)
+
+	FTSTicker::GetCoreTicker().RemoveTicker(ConfigFlushHandle);
+	ConfigFlushHandle.Reset();
+
+	if (!bConfigDirty)
+	{
+		return;
+	}
+
+	bConfigDirty = false;
+
+	// Only the default object is backed by the config file
+	if (HasAnyFlags(RF_ClassDefaultObject))
+	{
+		TryUpdateDefaultConfigFile();
+	}
+}
+
+void UFancyFoldersSettings::MarkConfigDirty()
+{
+	bConfigDirty = true;
+
+	if (BatchDepth > 0)
+	{
+		return;
+	}
+
+	// Every new edit pushes the write back, so a burst of edits only writes the file once
+	FTSTicker::GetCoreTicker().RemoveTicker(ConfigFlushHandle);
+	ConfigFlushHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateUObject(this, &ThisClass::OnConfigFlushDelayElapsed), ConfigFlushDelay);
+}
+
+bool UFancyFoldersSettings::OnConfigFlushDelayElapsed(float DeltaTime)
+{
+	ConfigFlushHandle.Reset();
+	FlushConfig();
+	return false;
 }
 
 void UFancyFoldersSettings::PreEditChange(FEditPropertyChain& PropertyAboutToChange)
@@ -174,7 +260,10 @@ void UFancyFoldersSettings::PostEditChangeProperty(FPropertyChangedEvent& Proper
 	Super::PostEditChangeProperty(PropertyChangedEvent);
 
 	FProperty* PropertyChanged = PropertyChangedEvent.MemberProperty;
-	if (PropertyChanged && PropertyChanged->GetFName() == GET_MEMBER_NAME_CHECKED(UFancyFoldersSettings, PathAssignments))
+	const FName PropertyName = PropertyChanged ? PropertyChanged->GetFName() : NAME_None;
+	const bool bAssignmentsChanged = !PropertyChanged || PropertyName == GET_MEMBER_NAME_CHECKED(UFancyFoldersSettings, PathAssignments);
+	const bool bPresetsChanged = !PropertyChanged || PropertyName == GET_MEMBER_NAME_CHECKED(UFancyFoldersSettings, PathPresets) || PropertyName == GET_MEMBER_NAME_CHECKED(UFancyFoldersSettings, FolderPresets);
+	if (PropertyChanged && bAssignmentsChanged)
 	{
 		for (FPathAssignedData Assignment : PathAssignments)
 		{
@@ -182,6 +271,105 @@ void UFancyFoldersSettings::PostEditChangeProperty(FPropertyChangedEvent& Proper
 			AssetViewUtils::SetPathColor(Assignment.Path, Assignment.Data.Color);
 		}
 	}
+
+	// Performance settings don't affect the rules, rebuilding them would also flush every cached result
+	if (bAssignmentsChanged || bPresetsChanged)
+	{
+		RebuildRules(bAssignmentsChanged);
+	}
+}
+
+FResolvedFolderData UFancyFoldersSettings::FindOrResolveData(const FString& Path) const
+{
+	if (ResolvedDataGeneration != Rules.GetGeneration())
+	{
+		ResolvedDataCache.Empty(ResolvedDataCacheSize);
+		ResolvedDataGeneration = Rules.GetGeneration();
+	}
+
+	if (const FResolvedFolderData* CachedData = ResolvedDataCache.FindAndTouch(Path))
+	{
+		CacheStats.Hits++;
+		return *CachedData;
+	}
+
+	CacheStats.Misses++;
+
+	FResolvedFolderData ResolvedData;
+	ResolvedData.Data = Rules.Resolve(Path);
+
+	ResolvedDataCache.Add(Path, ResolvedData);
+	return ResolvedData;
+}
+
+void UFancyFoldersSettings::RebuildRules(bool bAssignmentsChanged)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(UFancyFoldersSettings::RebuildRules)
+
+	if (bAssignmentsChanged)
+	{
+		Rules.BuildAssignments(PathAssignments);
+	}
+
+	Rules.BuildPresets(PathPresets, FolderPresets);
+}
+
+int32 UFancyFoldersSettings::FindAssignmentIndex(const FString& Path)
+{
+	int32 Index = Rules.FindAssignmentIndex(Path);
+
+	// The rules keep the order of PathAssignments, unless it was changed without going through the settings. Paths compare like the names the rules store them as
+	const bool bInSync = Rules.GetNumAssignments() == PathAssignments.Num() && (Index == INDEX_NONE || PathAssignments[Index].Path.Equals(Path, ESearchCase::IgnoreCase));
+	if (!bInSync)
+	{
+		Rules.BuildAssignments(PathAssignments);
+		Index = Rules.FindAssignmentIndex(Path);
+	}
+
+	return Index;
+}
+
+void UFancyFoldersSettings::SetAssignment(const FString& Path, const FFolderData& Data, bool bApplyToSubfolders)
+{
+	const int32 Index = FindAssignmentIndex(Path);
+	if (Index == INDEX_NONE)
+	{
+		PathAssignments.Add({Path, Data, bApplyToSubfolders});
+	}
+	else
+	{
+		PathAssignments[Index].Data = Data;
+		PathAssignments[Index].bApplyToSubfolders = bApplyToSubfolders;
+	}
+
+	Rules.SetAssignment(Path, Data, bApplyToSubfolders);
+}
+
+void UFancyFoldersSettings::RemoveAssignment(const FString& Path)
+{
+	const int32 Index = FindAssignmentIndex(Path);
+	if (Index != INDEX_NONE)
+	{
+		// Keeps the order, so the config file only changes where the assignment was
+		PathAssignments.RemoveAt(Index);
+	}
+
+	Rules.RemoveAssignment(Path);
+}
+
+void UFancyFoldersSettings::PostInitProperties()
+{
+	Super::PostInitProperties();
+
+	RebuildRules(true);
+}
+
+void UFancyFoldersSettings::PostReloadConfig(FProperty* PropertyThatWasLoaded)
+{
+	Super::PostReloadConfig(PropertyThatWasLoaded);
+
+	// The assignments only need to be rebuilt if they were part of the reload
+	RebuildRules(!PropertyThatWasLoaded || PropertyThatWasLoaded->GetFName() == GET_MEMBER_NAME_CHECKED(UFancyFoldersSettings, PathAssignments));
 }
 
 FName UFancyFoldersSettings::GetContainerName() const
@@ -206,3 +394,17 @@ FText UFancyFoldersSettings::GetSectionText() const
 	return FText::FromName(DisplaySectionName);
 }
 #endif
+
+FScopedFancyFoldersBatch::FScopedFancyFoldersBatch(UFancyFoldersSettings* InSettings) : Settings(InSettings)
+{
+	check(Settings);
+	Settings->BatchDepth++;
+}
+
+FScopedFancyFoldersBatch::~FScopedFancyFoldersBatch()
+{
+	if (--Settings->BatchDepth == 0 && Settings->bConfigDirty)
+	{
+		Settings->FlushConfig();
+	}
+}
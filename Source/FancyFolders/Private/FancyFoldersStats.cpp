@@ -0,0 +1,161 @@
+﻿// Copyright Out-of-the-Box Plugins 2018-2025. All Rights Reserved.
+
+#include "FancyFoldersStats.h"
+
+#include <atomic>
+#include <HAL/IConsoleManager.h>
+#include <ProfilingDebugging/CountersTrace.h>
+
+#include "FancyFolders.h"
+#include "FancyFoldersSettings.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Widgets Visited"), STAT_FancyFolders_WidgetsVisited, STATGROUP_FancyFolders);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Folders Assigned"), STAT_FancyFolders_FoldersAssigned, STATGROUP_FancyFolders);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Rules Resolved"), STAT_FancyFolders_RulesResolved, STATGROUP_FancyFolders);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Regex Evaluations"), STAT_FancyFolders_RegexEvaluations, STATGROUP_FancyFolders);
+
+TRACE_DECLARE_INT_COUNTER(FancyFolders_WidgetsVisited, TEXT("FancyFolders/WidgetsVisited"));
+TRACE_DECLARE_INT_COUNTER(FancyFolders_FoldersAssigned, TEXT("FancyFolders/FoldersAssigned"));
+TRACE_DECLARE_INT_COUNTER(FancyFolders_RulesResolved, TEXT("FancyFolders/RulesResolved"));
+TRACE_DECLARE_INT_COUNTER(FancyFolders_RegexEvaluations, TEXT("FancyFolders/RegexEvaluations"));
+TRACE_DECLARE_FLOAT_COUNTER(FancyFolders_TickTime, TEXT("FancyFolders/TickTime"));
+
+namespace FancyFolders::Stats
+{
+	namespace Private
+	{
+		constexpr int32 NumCounters = static_cast<int32>(ECounter::Num);
+
+		const TCHAR* CounterNames[NumCounters] = {
+			TEXT("Widgets visited"),
+			TEXT("Folders assigned"),
+			TEXT("Rules resolved"),
+			TEXT("Regex evaluations"),
+		};
+
+		/**
+		 * Counters of the frame in progress and the aggregates of all the closed frames since the last reset
+		 */
+		struct FStatsState
+		{
+			std::atomic<int32> CurrentFrame[NumCounters] = {};
+			int64 Totals[NumCounters] = {};
+			int32 Peaks[NumCounters] = {};
+			double TotalTickSeconds = 0.0;
+			double PeakTickSeconds = 0.0;
+			uint64 NumFrames = 0;
+		};
+
+		FStatsState& AccessState()
+		{
+			static FStatsState State;
+			return State;
+		}
+
+		void Reset()
+		{
+			FStatsState& State = AccessState();
+			for (int32 CounterIndex = 0; CounterIndex < NumCounters; CounterIndex++)
+			{
+				State.CurrentFrame[CounterIndex] = 0;
+				State.Totals[CounterIndex] = 0;
+				State.Peaks[CounterIndex] = 0;
+			}
+
+			State.TotalTickSeconds = 0.0;
+			State.PeakTickSeconds = 0.0;
+			State.NumFrames = 0;
+
+			GetMutableDefault<UFancyFoldersSettings>()->ResetCacheStats();
+		}
+
+		void Dump()
+		{
+			const FStatsState& State = AccessState();
+			const double NumFrames = FMath::Max<double>(State.NumFrames, 1.0);
+
+			UE_LOG(LogFancyFolders, Display, TEXT("FancyFolders stats over %llu frames:"), State.NumFrames);
+			UE_LOG(LogFancyFolders, Display, TEXT("  %-20s avg %8.3f ms, peak %8.3f ms"), TEXT("Tick time"), State.TotalTickSeconds * 1000.0 / NumFrames, State.PeakTickSeconds * 1000.0);
+
+			for (int32 CounterIndex = 0; CounterIndex < NumCounters; CounterIndex++)
+			{
+				UE_LOG(LogFancyFolders, Display, TEXT("  %-20s avg %8.2f, peak %8d, total %lld"), CounterNames[CounterIndex], State.Totals[CounterIndex] / NumFrames, State.Peaks[CounterIndex], State.Totals[CounterIndex]);
+			}
+
+			const FFancyFoldersCacheStats CacheStats = GetDefault<UFancyFoldersSettings>()->GetCacheStats();
+			const uint64 NumLookups = CacheStats.Hits + CacheStats.Misses;
+			UE_LOG(LogFancyFolders, Display, TEXT("  %-20s %llu hits, %llu misses (%.1f%% hit rate), %d paths cached"), TEXT("Resolve cache"), CacheStats.Hits, CacheStats.Misses, NumLookups > 0 ? CacheStats.Hits * 100.0 / NumLookups : 0.0, CacheStats.Num);
+		}
+	} // namespace Private
+
+	void Add(ECounter Counter, int32 Amount)
+	{
+		Private::AccessState().CurrentFrame[static_cast<int32>(Counter)].fetch_add(Amount, std::memory_order_relaxed);
+
+		switch (Counter)
+		{
+		case ECounter::WidgetsVisited:
+			INC_DWORD_STAT_BY(STAT_FancyFolders_WidgetsVisited, Amount);
+			break;
+		case ECounter::FoldersAssigned:
+			INC_DWORD_STAT_BY(STAT_FancyFolders_FoldersAssigned, Amount);
+			break;
+		case ECounter::RulesResolved:
+			INC_DWORD_STAT_BY(STAT_FancyFolders_RulesResolved, Amount);
+			break;
+		case ECounter::RegexEvaluations:
+			INC_DWORD_STAT_BY(STAT_FancyFolders_RegexEvaluations, Amount);
+			break;
+		default:
+			break;
+		}
+	}
+
+	void EndFrame(double TickSeconds)
+	{
+		Private::FStatsState& State = Private::AccessState();
+
+		int32 FrameCounters[Private::NumCounters];
+		for (int32 CounterIndex = 0; CounterIndex < Private::NumCounters; CounterIndex++)
+		{
+			FrameCounters[CounterIndex] = State.CurrentFrame[CounterIndex].exchange(0, std::memory_order_relaxed);
+			State.Totals[CounterIndex] += FrameCounters[CounterIndex];
+			State.Peaks[CounterIndex] = FMath::Max(State.Peaks[CounterIndex], FrameCounters[CounterIndex]);
+		}
+
+		State.TotalTickSeconds += TickSeconds;
+		State.PeakTickSeconds = FMath::Max(State.PeakTickSeconds, TickSeconds);
+		State.NumFrames++;
+
+		TRACE_COUNTER_SET(FancyFolders_WidgetsVisited, FrameCounters[static_cast<int32>(ECounter::WidgetsVisited)]);
+		TRACE_COUNTER_SET(FancyFolders_FoldersAssigned, FrameCounters[static_cast<int32>(ECounter::FoldersAssigned)]);
+		TRACE_COUNTER_SET(FancyFolders_RulesResolved, FrameCounters[static_cast<int32>(ECounter::RulesResolved)]);
+		TRACE_COUNTER_SET(FancyFolders_RegexEvaluations, FrameCounters[static_cast<int32>(ECounter::RegexEvaluations)]);
+		TRACE_COUNTER_SET(FancyFolders_TickTime, TickSeconds * 1000.0);
+	}
+
+	FScopedFrame::FScopedFrame() : StartCycles(FPlatformTime::Cycles64())
+	{
+	}
+
+	FScopedFrame::~FScopedFrame()
+	{
+		EndFrame(FPlatformTime::ToSeconds64(FPlatformTime::Cycles64() - StartCycles));
+	}
+} // namespace FancyFolders::Stats
+
+static FAutoConsoleCommand DumpStatsCommand(
+	TEXT("FancyFolders.DumpStats"),
+	TEXT("Prints the per frame averages and peaks of the FancyFolders counters since the last reset. Pass 'reset' to clear them afterward"),
+	FConsoleCommandWithArgsDelegate::CreateLambda(
+		[](const TArray<FString>& Args)
+		{
+			FancyFolders::Stats::Private::Dump();
+
+			if (Args.Contains(TEXT("reset")))
+			{
+				FancyFolders::Stats::Private::Reset();
+			}
+		}
+	)
+);
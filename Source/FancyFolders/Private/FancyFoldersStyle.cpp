@@ -2,26 +2,30 @@
 
 #include "FancyFoldersStyle.h"
 
+#include <Styling/AppStyle.h>
 #include <Styling/SlateStyleRegistry.h>
 
 #include "FancyFolders.h"
+#include "FancyFoldersSettings.h"
 
 FFancyFoldersStyle::FFancyFoldersStyle() : FSlateStyleSet(TEXT("FancyFoldersStyle"))
 {
-	const TArray<FString> IconFolders = FFancyFoldersModule::GetIconFoldersOnDisk();
-	for (const FString& Folder : IconFolders)
-	{
-		const FString Icon = FPaths::GetBaseFilename(Folder, true);
-
-		const FName NormalIcon = *FString::Printf(TEXT("%s.Normal"), *Icon);
-		Set(NormalIcon, new FSlateVectorImageBrush(Folder / TEXT("Normal.svg"), FVector2D(64, 64)));
+	// Only the icon table is built here, the brushes themselves are created the first time they are used
+	BuildIconTable();
+	IconManifestChangedHandle = FFancyFoldersModule::OnIconManifestChanged().AddRaw(this, &FFancyFoldersStyle::BuildIconTable);
+	FFancyFoldersModule::WatchIconFolders();
 
-		const FName ColumnOpenIcon = *FString::Printf(TEXT("%s.ColumnOpen"), *Icon);
-		Set(ColumnOpenIcon, new FSlateVectorImageBrush(Folder / TEXT("ColumnOpen.svg"), FVector2D(16, 16)));
+	auto SetDefaultFolderBrushes = [this](EFolderKind Kind, const FName& Normal, const FName& ColumnOpen, const FName& ColumnClosed)
+	{
+		const int32 KindOffset = static_cast<int32>(Kind) * NumFolderStates;
+		DefaultFolderBrushes[KindOffset + static_cast<int32>(EFolderState::Normal)] = FAppStyle::GetBrush(Normal);
+		DefaultFolderBrushes[KindOffset + static_cast<int32>(EFolderState::ColumnOpen)] = FAppStyle::GetBrush(ColumnOpen);
+		DefaultFolderBrushes[KindOffset + static_cast<int32>(EFolderState::ColumnClosed)] = FAppStyle::GetBrush(ColumnClosed);
+	};
 
-		const FName ColumnClosedIcon = *FString::Printf(TEXT("%s.ColumnClosed"), *Icon);
-		Set(ColumnClosedIcon, new FSlateVectorImageBrush(Folder / TEXT("ColumnClosed.svg"), FVector2D(16, 16)));
-	}
+	SetDefaultFolderBrushes(EFolderKind::Regular, "ContentBrowser.ListViewFolderIcon", "ContentBrowser.AssetTreeFolderOpen", "ContentBrowser.AssetTreeFolderClosed");
+	SetDefaultFolderBrushes(EFolderKind::Code, "ContentBrowser.ListViewCodeFolderIcon", "ContentBrowser.AssetTreeFolderOpenCode", "ContentBrowser.AssetTreeFolderClosedCode");
+	SetDefaultFolderBrushes(EFolderKind::Developer, "ContentBrowser.ListViewDeveloperFolderIcon", "ContentBrowser.AssetTreeFolderOpenDeveloper", "ContentBrowser.AssetTreeFolderClosedDeveloper");
 
 	FSlateStyleRegistry::RegisterSlateStyle(*this);
 }
@@ -34,5 +38,119 @@ FFancyFoldersStyle& FFancyFoldersStyle::Get()
 
 FFancyFoldersStyle::~FFancyFoldersStyle()
 {
+	FFancyFoldersModule::OnIconManifestChanged().Remove(IconManifestChangedHandle);
 	FSlateStyleRegistry::UnRegisterSlateStyle(*this);
 }
+
+void FFancyFoldersStyle::BuildIconTable()
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FFancyFoldersStyle::BuildIconTable)
+
+	const FFancyFoldersIconManifest& IconManifest = FFancyFoldersModule::GetIconManifest();
+
+	// Brushes stay registered in the style set when their icon disappears, widgets might still be pointing to them
+	TArray<const FSlateBrush*> PreviousBrushes = MoveTemp(FolderBrushes);
+	TMap<FName, int32> PreviousIndices = MoveTemp(IconIndices);
+
+	IconFolders = IconManifest.IconFolders;
+	IconIndices.Reset();
+	FolderBrushes.SetNumZeroed(IconFolders.Num() * NumFolderStates);
+
+	for (int32 IconIndex = 0; IconIndex < IconManifest.IconNames.Num(); IconIndex++)
+	{
+		const FName Icon(IconManifest.IconNames[IconIndex]);
+		IconIndices.Add(Icon, IconIndex);
+
+		if (const int32* PreviousIndex = PreviousIndices.Find(Icon))
+		{
+			for (int32 State = 0; State < NumFolderStates; State++)
+			{
+				FolderBrushes[IconIndex * NumFolderStates + State] = PreviousBrushes[*PreviousIndex * NumFolderStates + State];
+			}
+		}
+	}
+
+	if (GetDefault<UFancyFoldersSettings>()->UseIconAtlas())
+	{
+		if (IconAtlas)
+		{
+			RetiredIconAtlases.Add(MoveTemp(IconAtlas));
+		}
+
+		IconAtlas = MakeUnique<FFancyFoldersIconAtlas>();
+		if (!IconAtlas->Build(IconFolders))
+		{
+			IconAtlas.Reset();
+		}
+	}
+
+	IconTableVersion = IconManifest.Version;
+}
+
+const FSlateBrush* FFancyFoldersStyle::CreateFolderBrush(int32 IconIndex, EFolderState State)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FFancyFoldersStyle::CreateFolderBrush)
+
+	const FString& Folder = IconFolders[IconIndex];
+	const FString Icon = FPaths::GetBaseFilename(Folder, true);
+
+	FSlateVectorImageBrush* Brush = nullptr;
+	switch (State)
+	{
+	case EFolderState::Normal:
+		Brush = new FSlateVectorImageBrush(Folder / TEXT("Normal.svg"), FVector2D(64, 64));
+		Set(*FString::Printf(TEXT("%s.Normal"), *Icon), Brush);
+		break;
+	case EFolderState::ColumnOpen:
+		Brush = new FSlateVectorImageBrush(Folder / TEXT("ColumnOpen.svg"), FVector2D(16, 16));
+		Set(*FString::Printf(TEXT("%s.ColumnOpen"), *Icon), Brush);
+		break;
+	case EFolderState::ColumnClosed:
+		Brush = new FSlateVectorImageBrush(Folder / TEXT("ColumnClosed.svg"), FVector2D(16, 16));
+		Set(*FString::Printf(TEXT("%s.ColumnClosed"), *Icon), Brush);
+		break;
+	}
+
+	return Brush;
+}
+
+int32 FFancyFoldersStyle::FindIconIndex(const FName& Icon) const
+{
+	const int32* IconIndex = IconIndices.Find(Icon);
+	return IconIndex ? *IconIndex : INDEX_NONE;
+}
+
+const FSlateBrush* FFancyFoldersStyle::GetFolderBrush(int32 IconIndex, EFolderState State)
+{
+	const int32 BrushIndex = IconIndex * NumFolderStates + static_cast<int32>(State);
+	if (IconIndex == INDEX_NONE || !FolderBrushes.IsValidIndex(BrushIndex))
+	{
+		return nullptr;
+	}
+
+	if (IconAtlas)
+	{
+		// Icons which failed to rasterize fall back to their vector brush
+		if (const FSlateBrush* AtlasBrush = IconAtlas->GetBrush(IconIndex, State))
+		{
+			return AtlasBrush;
+		}
+	}
+
+	if (!FolderBrushes[BrushIndex])
+	{
+		FolderBrushes[BrushIndex] = CreateFolderBrush(IconIndex, State);
+	}
+
+	return FolderBrushes[BrushIndex];
+}
+
+uint32 FFancyFoldersStyle::GetIconTableVersion() const
+{
+	return IconTableVersion;
+}
+
+const FSlateBrush* FFancyFoldersStyle::GetDefaultFolderBrush(EFolderKind Kind, EFolderState State) const
+{
+	return DefaultFolderBrushes[static_cast<int32>(Kind) * NumFolderStates + static_cast<int32>(State)];
+}
@@ -2,101 +2,93 @@
 
 #include "FancyFoldersSubsystem.h"
 
+#include <AssetViewUtils.h>
 #include <ContentBrowserDataSource.h>
 #include <ContentBrowserDataSubsystem.h>
+#include <ContentBrowserModule.h>
 #include <Editor/UnrealEdEngine.h>
+#include <Framework/Docking/TabManager.h>
 #include <IContentBrowserDataModule.h>
 #include <Misc/EngineVersionComparison.h>
+#include <Misc/PackageName.h>
 #include <PathViewTypes.h>
 #include <SAssetView.h>
 #include <SPathView.h>
 #include <UnrealEdGlobals.h>
-
-#include "HackedRedefinition.h"
+#include <Widgets/Views/SListPanel.h>
 
 #include "FancyFoldersSettings.h"
+#include "FancyFoldersStats.h"
+#include "FancyFoldersStyle.h"
+#include "FancyFoldersWidgetQuery.h"
+
+DECLARE_CYCLE_STAT(TEXT("Tick"), STAT_FancyFolders_Tick, STATGROUP_FancyFolders);
+DECLARE_CYCLE_STAT(TEXT("Discover Views"), STAT_FancyFolders_DiscoverViews, STATGROUP_FancyFolders);
+DECLARE_CYCLE_STAT(TEXT("Assign Icon And Color"), STAT_FancyFolders_AssignIconAndColor, STATGROUP_FancyFolders);
 
 // TODO: Add option to clear data - icon & color
 // TODO: On startup we should transform all the currently assigned colors to rules in the settings
 // TODO: We need some way to also listen for color changes so they can be shared between users
-// TODO: On Tick - check if any of the AssetViewWidgets changed their type
 
 namespace Helpers
 {
-	void IterateOverWidgetsRecursively(const TArray<TSharedRef<SWidget>>& TopLevelWidgets, TFunctionRef<void(const TSharedRef<SWidget>& Widget)> Iterator)
+	/**
+	 * Gives access to the protected members of the path view's tree
+	 */
+	class SInternalAccessPathTreeView : public FPathTreeView
 	{
-		TRACE_CPUPROFILER_EVENT_SCOPE(FancyFolders::Helpers::IterateOverWidgetsRecursively)
-
-		TArray<TSharedRef<SWidget>> WidgetsToCheck;
-		WidgetsToCheck.Append(TopLevelWidgets);
-
-		while (!WidgetsToCheck.IsEmpty())
-		{
-			const TSharedRef<SWidget> CurrentWidget = WidgetsToCheck.Pop();
-			Iterator(CurrentWidget);
-
-			if (CurrentWidget->GetType() == TEXT("SWindow"))
-			{
-				const TSharedRef<SWindow> WidgetAsWindow = StaticCastSharedRef<SWindow>(CurrentWidget);
-				WidgetsToCheck.Append(WidgetAsWindow->GetChildWindows());
-			}
+	public:
+		FOnPathTreeExpansionChanged& AccessOnExpansionChanged() { return OnExpansionChanged; }
+	};
 
-			FChildren* Children = CurrentWidget->GetChildren();
-			if (!Children)
-			{
-				continue;
-			}
-
-			for (int i = 0; i < Children->Num(); i++)
-			{
-				const TSharedRef<SWidget> ChildWidget = Children->GetChildAt(i);
-				WidgetsToCheck.Add(ChildWidget);
-			}
-		}
+	SInternalAccessPathTreeView& AccessPathTreeView(const FPathTreeView& TreeView)
+	{
+		return *reinterpret_cast<SInternalAccessPathTreeView*>(const_cast<FPathTreeView*>(&TreeView));
 	}
 
-	template <typename T>
-	TSharedPtr<T> FindChildWidgetOfType(const TSharedRef<SWidget>& Parent, const FName& WidgetType = T::StaticWidgetClass().GetWidgetType())
+	/**
+	 * Gives access to the protected members of any list, tile or tree view
+	 */
+	class SInternalAccessTableView : public STableViewBase
 	{
-		TRACE_CPUPROFILER_EVENT_SCOPE(FancyFolders::Helpers::FindChildWidgetOfType)
-
-		TSharedPtr<SWidget> Result;
+	public:
+		FOnTableViewScrolled& AccessOnTableViewScrolled() { return OnTableViewScrolled; }
+		FChildren* GetGeneratedRows() const { return ItemsPanel.IsValid() ? ItemsPanel->GetChildren() : nullptr; }
+	};
 
-		TArray<TSharedRef<SWidget>> TopLevelWidgets;
-		TopLevelWidgets.Add(Parent);
-
-		IterateOverWidgetsRecursively(
-			TopLevelWidgets,
-			[&Result, WidgetType](const TSharedRef<SWidget>& Widget)
-			{
-				if (Widget->GetType() == WidgetType && Widget->GetVisibility() == EVisibility::Visible)
-				{
-					Result = Widget;
-				}
-			}
-		);
-
-		return StaticCastSharedPtr<T>(Result);
+	SInternalAccessTableView& AccessTableView(const STableViewBase& TableView)
+	{
+		return *reinterpret_cast<SInternalAccessTableView*>(const_cast<STableViewBase*>(&TableView));
 	}
 
-	TMap<FName, FTreeItemPtr> GetInternalPathData(const TSharedRef<SPathView>& PathView)
+	/**
+	 * Returns a hash of the rows a table view generated, from their number and the first & last one
+	 */
+	uint32 HashGeneratedRows(const STableViewBase& TableView)
 	{
-		TRACE_CPUPROFILER_EVENT_SCOPE(FancyFolders::Helpers::GetInternalPathData)
-
-		class SInternalAccessPathView : public SPathView
+		FChildren* Rows = AccessTableView(TableView).GetGeneratedRows();
+		if (!Rows || Rows->Num() == 0)
 		{
-		public:
-#if UE_VERSION_NEWER_THAN(5, 4, 4)
-			TMap<FName, FTreeItemPtr> MyCoolGetter() const { return TreeData->VirtualPathToItem; }
-#else
-			TMap<FName, FTreeItemPtr> MyCoolGetter() const { return TreeItemLookup; }
-#endif
-		};
+			return 0;
+		}
 
-		TMap<FName, FTreeItemPtr> Data = reinterpret_cast<SInternalAccessPathView*>(&PathView.Get())->MyCoolGetter();
-		return Data;
+		uint32 Hash = GetTypeHash(Rows->Num());
+		Hash = HashCombineFast(Hash, GetTypeHash(&Rows->GetChildAt(0).Get()));
+		Hash = HashCombineFast(Hash, GetTypeHash(&Rows->GetChildAt(Rows->Num() - 1).Get()));
+		return Hash;
 	}
 
+	/**
+	 * Heap predicate putting the pending folder closest to the cursor on top
+	 */
+	struct FCloserToCursor
+	{
+		bool operator()(const FPendingContentBrowserFolder& Lhs, const FPendingContentBrowserFolder& Rhs) const
+		{
+			return Lhs.Priority < Rhs.Priority;
+		}
+	};
+
 	bool IsItemDeveloperContent(const FContentBrowserItem& InItem)
 	{
 		TRACE_CPUPROFILER_EVENT_SCOPE(FancyFolders::Helpers::IsItemDeveloperContent)
@@ -135,58 +127,108 @@ namespace Helpers
 	}
 } // namespace Helpers
 
-bool FContentBrowserFolder::IsOpenNow() const
+bool FContentBrowserFolder::IsColumnViewNow() const
 {
-	TRACE_CPUPROFILER_EVENT_SCOPE(FContentBrowserFolder::IsOpenNow)
-
-	if (!GetFolderState.IsBound())
-	{
-		return false;
-	}
+	return FolderImage->GetDesiredSize().X < 32.0 && FolderImage->GetDesiredSize().Y < 32.0;
+}
 
-	return GetFolderState.Execute();
+bool FContentBrowserFolder::operator==(const FContentBrowserFolder& Other) const
+{
+	return FolderImage == Other.FolderImage;
 }
 
-bool FContentBrowserFolder::IsColumnViewNow() const
+UFancyFoldersSubsystem& UFancyFoldersSubsystem::Get()
 {
-	return FolderImage->GetDesiredSize().X < 32.0 && FolderImage->GetDesiredSize().Y < 32.0;
+	return *GEditor->GetEditorSubsystem<UFancyFoldersSubsystem>();
 }
 
-FString FContentBrowserFolder::GetPackagePath() const
+void UFancyFoldersSubsystem::SetFoldersIcon(const FString& Icon, TConstArrayView<FString> Folders)
 {
-	TRACE_CPUPROFILER_EVENT_SCOPE(FContentBrowserFolder::GetPackagePath)
+	TRACE_CPUPROFILER_EVENT_SCOPE(UFancyFoldersSubsystem::SetFoldersIcon)
+
+	UFancyFoldersSettings* Settings = GetMutableDefault<UFancyFoldersSettings>();
+	FScopedFancyFoldersBatch Batch(Settings);
+
+	const FName IconName(Icon);
+	for (const FString& Folder : Folders)
+	{
+		Settings->UpdateOrCreateAssignmentIcon(Folder, IconName);
+	}
 
-	FName ConvertedPath;
-	IContentBrowserDataModule::Get().GetSubsystem()->TryConvertVirtualPath(FolderPath, ConvertedPath);
-	return ConvertedPath.ToString();
+	RequestRefresh();
 }
 
-FContentBrowserItem FContentBrowserFolder::GetContentBrowserItem() const
+void UFancyFoldersSubsystem::SetFoldersColor(const FLinearColor& Color, TConstArrayView<FString> Folders)
 {
-	TRACE_CPUPROFILER_EVENT_SCOPE(FContentBrowserFolder::GetContentBrowserItem)
+	TRACE_CPUPROFILER_EVENT_SCOPE(UFancyFoldersSubsystem::SetFoldersColor)
+
+	UFancyFoldersSettings* Settings = GetMutableDefault<UFancyFoldersSettings>();
+	FScopedFancyFoldersBatch Batch(Settings);
+
+	for (const FString& Folder : Folders)
+	{
+		Settings->UpdateOrCreateAssignmentColor(Folder, Color);
+	}
 
-	return IContentBrowserDataModule::Get().GetSubsystem()->GetItemAtPath(FName(FolderPath), EContentBrowserItemTypeFilter::IncludeFolders);
+	ApplyPathColors(Folders, Color);
+	RequestRefresh();
 }
 
-bool FContentBrowserFolder::operator==(const FContentBrowserFolder& Other) const
+void UFancyFoldersSubsystem::SetFoldersData(const FFolderData& Data, TConstArrayView<FString> Folders)
 {
-	return FolderImage == Other.FolderImage;
+	TRACE_CPUPROFILER_EVENT_SCOPE(UFancyFoldersSubsystem::SetFoldersData)
+
+	UFancyFoldersSettings* Settings = GetMutableDefault<UFancyFoldersSettings>();
+	FScopedFancyFoldersBatch Batch(Settings);
+
+	for (const FString& Folder : Folders)
+	{
+		Settings->UpdateOrCreateAssignment(Folder, Data);
+	}
+
+	ApplyPathColors(Folders, Data.Color);
+	RequestRefresh();
 }
 
-UFancyFoldersSubsystem& UFancyFoldersSubsystem::Get()
+void UFancyFoldersSubsystem::ClearFolders(TConstArrayView<FString> Folders)
 {
-	return *GEditor->GetEditorSubsystem<UFancyFoldersSubsystem>();
+	TRACE_CPUPROFILER_EVENT_SCOPE(UFancyFoldersSubsystem::ClearFolders)
+
+	UFancyFoldersSettings* Settings = GetMutableDefault<UFancyFoldersSettings>();
+	FScopedFancyFoldersBatch Batch(Settings);
+
+	for (const FString& Folder : Folders)
+	{
+		Settings->UpdateOrCreateAssignmentIcon(Folder, {});
+		Settings->UpdateOrCreateAssignmentColor(Folder, {});
+	}
+
+	ApplyPathColors(Folders, {});
+	RequestRefresh();
 }
 
-void UFancyFoldersSubsystem::SetFoldersIcon(const FString& Icon, TArray<FString> Folders)
+TArray<FFancyFolderQueryResult> UFancyFoldersSubsystem::ResolveFolders(TConstArrayView<FString> Folders) const
 {
-	TRACE_CPUPROFILER_EVENT_SCOPE(UFancyFoldersSubsystem::SetFoldersIcon)
+	TRACE_CPUPROFILER_EVENT_SCOPE(UFancyFoldersSubsystem::ResolveFolders)
 
-	for (const FString& Folder : Folders)
+	const UFancyFoldersSettings* Settings = GetDefault<UFancyFoldersSettings>();
+
+	TArray<FFancyFolderQueryResult> Results;
+	Results.SetNum(Folders.Num());
+
+	for (int32 Index = 0; Index < Folders.Num(); Index++)
 	{
-		UFancyFoldersSettings* Settings = GetMutableDefault<UFancyFoldersSettings>();
-		Settings->UpdateOrCreateAssignmentIcon(Folder, FName(Icon));
+		FFancyFolderQueryResult& Result = Results[Index];
+		Result.Path = Folders[Index];
+
+		if (TOptional<FFolderData> Data = Settings->GetDataForPath(Folders[Index]))
+		{
+			Result.bHasData = true;
+			Result.Data = MoveTemp(*Data);
+		}
 	}
+
+	return Results;
 }
 
 bool UFancyFoldersSubsystem::HasFolderIcon(const FString& Path) const
@@ -206,259 +248,1079 @@ void UFancyFoldersSubsystem::ClearFolderIcon(const FString& Path)
 	Settings->UpdateOrCreateAssignmentIcon(Path, {});
 }
 
-void UFancyFoldersSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+void UFancyFoldersSubsystem::K2_SetFoldersIcon(const TArray<FString>& Folders, FName Icon)
 {
-	TRACE_CPUPROFILER_EVENT_SCOPE(UFancyFoldersSubsystem::Initialize)
+	SetFoldersIcon(Icon.ToString(), Folders);
+}
 
-	if (FSlateApplication::IsInitialized())
-	{
-		FSlateApplication& SlateApp = FSlateApplication::Get();
-		SlateApp.OnPostTick().AddUObject(this, &ThisClass::OnPostTick);
-	}
+void UFancyFoldersSubsystem::K2_SetFoldersColor(const TArray<FString>& Folders, FLinearColor Color)
+{
+	SetFoldersColor(Color, Folders);
 }
 
-void UFancyFoldersSubsystem::OnPostTick(float DeltaTime)
+void UFancyFoldersSubsystem::K2_SetFoldersData(const TArray<FString>& Folders, const FFolderData& Data)
 {
-	TRACE_CPUPROFILER_EVENT_SCOPE(UFancyFoldersSubsystem::OnPostTick)
+	SetFoldersData(Data, Folders);
+}
 
-	if (ShouldUpdateContentBrowsers())
-	{
-		SyncFolderColorData();
+void UFancyFoldersSubsystem::K2_ClearFolders(const TArray<FString>& Folders)
+{
+	ClearFolders(Folders);
+}
 
-		RefreshAssetViewFolders();
-		RefreshPathViewFolders();
-	}
+TArray<FFancyFolderQueryResult> UFancyFoldersSubsystem::K2_ResolveFolders(const TArray<FString>& Folders) const
+{
+	return ResolveFolders(Folders);
 }
 
-void UFancyFoldersSubsystem::AssignIconAndColor(const FContentBrowserFolder& Folder)
+void UFancyFoldersSubsystem::RequestRefresh()
 {
-	TRACE_CPUPROFILER_EVENT_SCOPE(UFancyFoldersSubsystem::AssignIconAndColor)
+	bRefreshPending = true;
+	RefreshDeadline = FPlatformTime::Seconds() + RefreshSettleTime;
+}
+
+void UFancyFoldersSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(UFancyFoldersSubsystem::Initialize)
 
-	const FContentBrowserItem ContentBrowserFolder = Folder.GetContentBrowserItem();
-	if (!ContentBrowserFolder.IsValid())
+	if (!FSlateApplication::IsInitialized())
 	{
 		return;
 	}
 
-	const TSharedRef<SImage> Image = Folder.FolderImage;
-	Image->SetImage(GetIconForFolder(Folder));
-	Image->SetColorAndOpacity(GetColorForFolder(Folder));
+	// Only cheap hooks are registered until the first content browser shows up, see Activate
+	FocusChangingHandle = FSlateApplication::Get().OnFocusChanging().AddUObject(this, &ThisClass::OnFocusChanging);
+
+	const TSharedRef<FGlobalTabmanager> TabManager = FGlobalTabmanager::Get();
+	ActiveTabChangedHandle = TabManager->OnActiveTabChanged_Subscribe(FOnActiveTabChanged::FDelegate::CreateUObject(this, &ThisClass::OnTabChanged));
+	TabForegroundedHandle = TabManager->OnTabForegrounded_Subscribe(FOnActiveTabChanged::FDelegate::CreateUObject(this, &ThisClass::OnTabChanged));
+
+	// Content browser tabs restored from the layout don't always go through the tab events
+	ActivationProbeHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateUObject(this, &ThisClass::ProbeForContentBrowser), ActivationProbeInterval);
 }
 
-const FSlateBrush* UFancyFoldersSubsystem::GetIconForFolder(FContentBrowserFolder Folder) const
+void UFancyFoldersSubsystem::Activate()
 {
-	TRACE_CPUPROFILER_EVENT_SCOPE(UFancyFoldersSubsystem::GetIconForFolder)
+	TRACE_CPUPROFILER_EVENT_SCOPE(UFancyFoldersSubsystem::Activate)
+
+	if (bActive)
+	{
+		return;
+	}
+
+	bActive = true;
 
-	const UFancyFoldersSettings* const Settings = GetDefault<UFancyFoldersSettings>();
+	FTSTicker::GetCoreTicker().RemoveTicker(ActivationProbeHandle);
+	ActivationProbeHandle.Reset();
 
-	const bool bIsOpen = Folder.IsOpenNow();
-	const bool bIsColumnView = Folder.IsColumnViewNow();
+	FSlateApplication& SlateApp = FSlateApplication::Get();
+	PostTickHandle = SlateApp.OnPostTick().AddUObject(this, &ThisClass::OnPostTick);
+	WindowBeingDestroyedHandle = SlateApp.OnWindowBeingDestroyed().AddUObject(this, &ThisClass::OnWindowBeingDestroyed);
 
-	if (const FSlateBrush* CustomIcon = Settings->GetIconForPath(Folder.GetPackagePath(), bIsColumnView, bIsOpen))
+	if (UContentBrowserDataSubsystem* ContentBrowserData = IContentBrowserDataModule::Get().GetSubsystem())
 	{
-		return CustomIcon;
+		ItemDataUpdatedHandle = ContentBrowserData->OnItemDataUpdated().AddUObject(this, &ThisClass::OnContentBrowserItemDataUpdated);
+		ItemDataRefreshedHandle = ContentBrowserData->OnItemDataRefreshed().AddUObject(this, &ThisClass::OnContentBrowserItemDataRefreshed);
 	}
 
-	const FContentBrowserItem ContentBrowserFolder = Folder.GetContentBrowserItem();
-	const bool bCodeFolder = Helpers::IsItemCodeContent(ContentBrowserFolder);
-	const bool bDeveloperFolder = Helpers::IsItemDeveloperContent(ContentBrowserFolder);
+	ContentPathMountedHandle = FPackageName::OnContentPathMounted().AddUObject(this, &ThisClass::OnContentPathMountChanged);
+	ContentPathDismountedHandle = FPackageName::OnContentPathDismounted().AddUObject(this, &ThisClass::OnContentPathMountChanged);
 
-	const FSlateBrush* FolderBrush;
-	const FSlateBrush* FolderOpenBrush;
-	const FSlateBrush* FolderClosedBrush;
+	// Each of these changes which folders the views show, without any content browser data changing
+	FContentBrowserModule& ContentBrowserModule = FModuleManager::LoadModuleChecked<FContentBrowserModule>(TEXT("ContentBrowser"));
+	AssetPathChangedHandle = ContentBrowserModule.GetOnAssetPathChanged().AddUObject(this, &ThisClass::OnAssetPathChanged);
+	FilterChangedHandle = ContentBrowserModule.GetOnFilterChanged().AddUObject(this, &ThisClass::OnFilterChanged);
+	SearchBoxChangedHandle = ContentBrowserModule.GetOnSearchBoxChanged().AddUObject(this, &ThisClass::OnSearchBoxChanged);
+	SourcesViewChangedHandle = ContentBrowserModule.GetOnSourcesViewChanged().AddUObject(this, &ThisClass::OnSourcesViewChanged);
+
+	bViewsDirty = true;
+	RequestRefresh();
+}
+
+bool UFancyFoldersSubsystem::ProbeForContentBrowser(float DeltaTime)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(UFancyFoldersSubsystem::ProbeForContentBrowser)
 
-	if (bCodeFolder)
+	if (IsAnyContentBrowserTabOpen())
 	{
-		FolderBrush = FAppStyle::GetBrush("ContentBrowser.ListViewCodeFolderIcon");
-		FolderOpenBrush = FAppStyle::GetBrush("ContentBrowser.AssetTreeFolderOpenCode");
-		FolderClosedBrush = FAppStyle::GetBrush("ContentBrowser.AssetTreeFolderClosedCode");
+		Activate();
 	}
-	else if (bDeveloperFolder)
+
+	return !bActive;
+}
+
+bool UFancyFoldersSubsystem::IsAnyContentBrowserTabOpen()
+{
+	static const FName ContentBrowserTabs[] = {TEXT("ContentBrowserTab1"), TEXT("ContentBrowserTab2"), TEXT("ContentBrowserTab3"), TEXT("ContentBrowserTab4")};
+
+	const TSharedRef<FGlobalTabmanager> TabManager = FGlobalTabmanager::Get();
+	for (const FName& ContentBrowserTab : ContentBrowserTabs)
 	{
-		FolderBrush = FAppStyle::GetBrush("ContentBrowser.ListViewDeveloperFolderIcon");
-		FolderOpenBrush = FAppStyle::GetBrush("ContentBrowser.AssetTreeFolderOpenDeveloper");
-		FolderClosedBrush = FAppStyle::GetBrush("ContentBrowser.AssetTreeFolderClosedDeveloper");
+		if (TabManager->FindExistingLiveTab(FTabId(ContentBrowserTab)))
+		{
+			return true;
+		}
 	}
-	else
+
+	return false;
+}
+
+void UFancyFoldersSubsystem::Deinitialize()
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(UFancyFoldersSubsystem::Deinitialize)
+
+	FTSTicker::GetCoreTicker().RemoveTicker(ActivationProbeHandle);
+
+	if (FSlateApplication::IsInitialized())
 	{
-		FolderBrush = FAppStyle::GetBrush("ContentBrowser.ListViewFolderIcon");
-		FolderOpenBrush = FAppStyle::GetBrush("ContentBrowser.AssetTreeFolderOpen");
-		FolderClosedBrush = FAppStyle::GetBrush("ContentBrowser.AssetTreeFolderClosed");
+		FSlateApplication& SlateApp = FSlateApplication::Get();
+		SlateApp.OnPostTick().Remove(PostTickHandle);
+		SlateApp.OnWindowBeingDestroyed().Remove(WindowBeingDestroyedHandle);
+		SlateApp.OnFocusChanging().Remove(FocusChangingHandle);
+
+		const TSharedRef<FGlobalTabmanager> TabManager = FGlobalTabmanager::Get();
+		TabManager->OnActiveTabChanged_Unsubscribe(ActiveTabChangedHandle);
+		TabManager->OnTabForegrounded_Unsubscribe(TabForegroundedHandle);
 	}
 
-	if (bIsColumnView)
+	if (IContentBrowserDataModule* ContentBrowserDataModule = FModuleManager::GetModulePtr<IContentBrowserDataModule>(TEXT("ContentBrowserData")))
 	{
-		if (bIsOpen)
+		if (UContentBrowserDataSubsystem* ContentBrowserData = ContentBrowserDataModule->GetSubsystem())
 		{
-			return FolderOpenBrush;
+			ContentBrowserData->OnItemDataUpdated().Remove(ItemDataUpdatedHandle);
+			ContentBrowserData->OnItemDataRefreshed().Remove(ItemDataRefreshedHandle);
 		}
+	}
+
+	FPackageName::OnContentPathMounted().Remove(ContentPathMountedHandle);
+	FPackageName::OnContentPathDismounted().Remove(ContentPathDismountedHandle);
 
-		return FolderClosedBrush;
+	if (FContentBrowserModule* ContentBrowserModule = FModuleManager::GetModulePtr<FContentBrowserModule>(TEXT("ContentBrowser")))
+	{
+		ContentBrowserModule->GetOnAssetPathChanged().Remove(AssetPathChangedHandle);
+		ContentBrowserModule->GetOnFilterChanged().Remove(FilterChangedHandle);
+		ContentBrowserModule->GetOnSearchBoxChanged().Remove(SearchBoxChangedHandle);
+		ContentBrowserModule->GetOnSourcesViewChanged().Remove(SourcesViewChangedHandle);
 	}
 
-	return FolderBrush;
+	UnhookPathTrees();
+	UnhookTableViews();
+
+	// Edits still waiting for their delayed write would be lost otherwise
+	GetMutableDefault<UFancyFoldersSettings>()->FlushConfig();
+
+	Super::Deinitialize();
 }
 
-FSlateColor UFancyFoldersSubsystem::GetColorForFolder(FContentBrowserFolder Folder) const
+void UFancyFoldersSubsystem::OnPostTick(float DeltaTime)
 {
-	TRACE_CPUPROFILER_EVENT_SCOPE(UFancyFoldersSubsystem::GetColorForFolder)
+	TRACE_CPUPROFILER_EVENT_SCOPE(UFancyFoldersSubsystem::OnPostTick)
+	SCOPE_CYCLE_COUNTER(STAT_FancyFolders_Tick);
 
-	const UFancyFoldersSettings* const Settings = GetDefault<UFancyFoldersSettings>();
+	const FancyFolders::Stats::FScopedFrame StatsFrame;
 
-	if (const TOptional<FLinearColor> CustomColor = Settings->GetColorForPath(Folder.GetPackagePath()))
+	if (IsRefreshSuspended())
 	{
-		return CustomColor.GetValue();
+		return;
 	}
 
-	return AssetViewUtils::GetDefaultColor();
-}
+	// The change signals are polled at the refresh rate as well, most frames do nothing at all
+	const double Now = FPlatformTime::Seconds();
+	const UFancyFoldersSettings* Settings = GetDefault<UFancyFoldersSettings>();
+	if (Now - LastRefreshTime < Settings->GetRefreshInterval(FSlateApplication::Get().IsActive()))
+	{
+		return;
+	}
 
-void UFancyFoldersSubsystem::RefreshAssetViewFolders()
-{
-	TRACE_CPUPROFILER_EVENT_SCOPE(UFancyFoldersSubsystem::RefreshAssetViewFolders)
+	LastRefreshTime = Now;
 
-	TArray<TSharedRef<SWidget>> AssetViewWidgets = TArray<TSharedRef<SWidget>>(GetAllAssetViews());
+	// Requests made during PIE or while the editor wasn't focused outlived their deadline, they get the full settle time once refreshing resumes
+	if (bRefreshPending && Now > RefreshDeadline)
+	{
+		RefreshDeadline = Now + RefreshSettleTime;
+	}
 
-	Helpers::IterateOverWidgetsRecursively(
-		AssetViewWidgets,
-		[this](const TSharedRef<SWidget>& Widget)
-		{
-			const TSharedPtr<FTagMetaData> MetaTag = Widget->GetMetaData<FTagMetaData>();
-			if (!MetaTag)
-			{
-				return;
-			}
+	DetectChanges();
 
-			const FName& PathTag = MetaTag->Tag;
-			// TODO: Find a better way to confirm this is a virtual path
-			if (!PathTag.ToString().StartsWith("/"))
-			{
-				return;
-			}
+	if (Now > RefreshDeadline && PendingFolders.IsEmpty() && !IsCollecting())
+	{
+		return;
+	}
 
-			if (const TSharedPtr<SImage> FoundImage = Helpers::FindChildWidgetOfType<SImage>(Widget))
-			{
-				FContentBrowserFolder Folder = {PathTag, FoundImage.ToSharedRef()};
-				AssignIconAndColor(Folder);
-			}
-		}
-	);
+	if (bViewsDirty)
+	{
+		DiscoverViews();
+	}
+
+	if (AssetViews.IsEmpty() && PathViews.IsEmpty())
+	{
+		// No content browser is open, nothing to refresh. The next one to show up is refreshed through the view discovery
+		PendingFolders.Reset();
+		PendingImages.Reset();
+		CollectionViews.Reset();
+		bRefreshPending = false;
+		return;
+	}
+
+	if (!ShouldUpdateContentBrowsers())
+	{
+		return;
+	}
+
+	// Passes don't wait for the queue to empty, a new one re-prioritizes whatever the previous ones left behind
+	if (!IsCollecting() && Now <= RefreshDeadline)
+	{
+		StartCollection();
+	}
+
+	const double StartTime = FPlatformTime::Seconds();
+	const double TimeBudget = Settings->GetRefreshTimeBudget();
+
+	if (IsCollecting())
+	{
+		// While folders are waiting the collection only gets half the budget, so the closest ones keep being assigned
+		const double CollectionBudget = PendingFolders.IsEmpty() ? TimeBudget : TimeBudget * 0.5;
+		CollectFolders(StartTime + CollectionBudget);
+	}
+
+	ProcessPendingFolders(StartTime + TimeBudget);
 }
 
-void UFancyFoldersSubsystem::RefreshPathViewFolders()
+void UFancyFoldersSubsystem::DetectChanges()
 {
-	TRACE_CPUPROFILER_EVENT_SCOPE(UFancyFoldersSubsystem::RefreshPathViewFolders)
+	TRACE_CPUPROFILER_EVENT_SCOPE(UFancyFoldersSubsystem::DetectChanges)
 
-	TArray<TSharedRef<SPathView>> PathWidgets = GetAllPathWidgets();
-	for (const TSharedRef<SPathView>& PathWidget : PathWidgets)
+	const int32 TopLevelWindowCount = FSlateApplication::Get().GetTopLevelWindows().Num();
+	if (TopLevelWindowCount != LastTopLevelWindowCount)
 	{
-		TMap<FName, FTreeItemPtr> Data = Helpers::GetInternalPathData(PathWidget);
+		LastTopLevelWindowCount = TopLevelWindowCount;
+		bViewsDirty = true;
+		RequestRefresh();
+	}
 
-#if UE_VERSION_NEWER_THAN(5, 4, 4)
-		const FName PathWidgetType = TEXT("STreeView<TSharedPtr<FTreeItem>>");
-#else
-		const FName PathWidgetType =  TEXT("STreeView< TSharedPtr<FTreeItem> >");
-#endif
+	const uint32 RulesGeneration = GetDefault<UFancyFoldersSettings>()->GetRulesGeneration();
+	if (RulesGeneration != LastRulesGeneration)
+	{
+		LastRulesGeneration = RulesGeneration;
+		RequestRefresh();
+	}
 
-		const TSharedPtr<STreeView<TSharedPtr<FTreeItem>>> TreeViewPtr = Helpers::FindChildWidgetOfType<STreeView<TSharedPtr<FTreeItem>>>(PathWidget, PathWidgetType);
-		if (!TreeViewPtr)
+	const uint32 IconTableVersion = FFancyFoldersStyle::Get().GetIconTableVersion();
+	if (IconTableVersion != LastIconTableVersion)
+	{
+		LastIconTableVersion = IconTableVersion;
+		RequestRefresh();
+	}
+
+	// Colors picked from the content browser's own menu only show up in the PathColor section, the refresh syncs them.
+	// Added & removed colors change the entry count right away, edited ones are caught by the slower hash check
+	const FConfigSection* PathColorSection = GConfig->GetSection(TEXT("PathColor"), false, GEditorPerProjectIni);
+	const int32 NumPathColors = PathColorSection ? PathColorSection->Num() : 0;
+	const double Now = FPlatformTime::Seconds();
+	if (NumPathColors != LastNumPathColors || Now >= NextPathColorPollTime)
+	{
+		LastNumPathColors = NumPathColors;
+		NextPathColorPollTime = Now + PathColorPollInterval;
+
+		if (HashPathColorSection() != CachedPathColorsHash)
 		{
-			return;
+			RequestRefresh();
 		}
+	}
 
-		for (const TTuple<FName, FTreeItemPtr>& Entry : Data)
+	// Switching between tiles, list & columns replaces every row of the asset view
+	uint32 AssetViewTypesHash = 0;
+	for (const TWeakPtr<SAssetView>& AssetView : AssetViews)
+	{
+		if (const TSharedPtr<SAssetView> AssetViewPtr = AssetView.Pin())
 		{
-			TWeakPtr<FTreeItem> EntryValue = Entry.Value;
+			AssetViewTypesHash = HashCombineFast(AssetViewTypesHash, GetTypeHash(static_cast<int32>(AssetViewPtr->GetCurrentViewType())));
+		}
+	}
+
+	if (AssetViewTypesHash != LastAssetViewTypesHash)
+	{
+		LastAssetViewTypesHash = AssetViewTypesHash;
+		RequestRefresh();
+	}
 
-			if (const TSharedPtr<ITableRow> Widget = TreeViewPtr->WidgetFromItem(EntryValue.Pin()))
+	// Rows are also generated without any event, e.g. when a view is resized, a splitter is dragged or the thumbnail size changes
+	for (FHookedTableView& Hook : HookedTableViews)
+	{
+		if (const TSharedPtr<STableViewBase> TableView = Hook.TableView.Pin())
+		{
+			const uint32 GeneratedRowsHash = Helpers::HashGeneratedRows(*TableView);
+			if (GeneratedRowsHash != Hook.GeneratedRowsHash)
 			{
-				if (const TSharedPtr<SImage> FoundImage = Helpers::FindChildWidgetOfType<SImage>(Widget->GetContent().ToSharedRef()))
-				{
-					FContentBrowserFolder Folder = {
-						Entry.Key,
-						FoundImage.ToSharedRef(),
-						TDelegate<bool()>::CreateLambda(
-							[=]()
-							{
-								return TreeViewPtr->IsItemExpanded(EntryValue.Pin());
-							}
-						)};
-					AssignIconAndColor(Folder);
-				}
+				Hook.GeneratedRowsHash = GeneratedRowsHash;
+				RequestRefresh();
 			}
 		}
 	}
 }
 
-TArray<TSharedRef<SAssetView>> UFancyFoldersSubsystem::GetAllAssetViews()
+void UFancyFoldersSubsystem::OnContentBrowserItemDataUpdated(TArrayView<const FContentBrowserItemDataUpdate> InUpdatedItems)
 {
-	TRACE_CPUPROFILER_EVENT_SCOPE(UFancyFoldersSubsystem::GetAllAssetViews)
-
-	TArray<TSharedRef<SAssetView>> Result;
+	TRACE_CPUPROFILER_EVENT_SCOPE(UFancyFoldersSubsystem::OnContentBrowserItemDataUpdated)
 
-	TArray<TSharedRef<SWidget>> TopLevelWidgets;
-	TopLevelWidgets.Append(FSlateApplication::Get().GetTopLevelWindows());
+	for (const FContentBrowserItemDataUpdate& Update : InUpdatedItems)
+	{
+		if (!Update.GetItemData().IsFolder())
+		{
+			continue;
+		}
 
-	Helpers::IterateOverWidgetsRecursively(
-		TopLevelWidgets,
-		[&Result](const TSharedRef<SWidget>& Widget)
+		FolderRecords.Remove(Update.GetItemData().GetVirtualPath());
+		if (Update.GetUpdateType() == EContentBrowserItemUpdateType::Moved)
 		{
-			if (Widget->GetType() == TEXT("SAssetView"))
-			{
-				Result.Add(StaticCastSharedRef<SAssetView>(Widget));
-			}
+			FolderRecords.Remove(Update.GetPreviousVirtualPath());
 		}
-	);
+	}
 
-	return Result;
+	RequestRefresh();
 }
 
-TArray<TSharedRef<SPathView>> UFancyFoldersSubsystem::GetAllPathWidgets()
+void UFancyFoldersSubsystem::OnContentBrowserItemDataRefreshed()
 {
-	TRACE_CPUPROFILER_EVENT_SCOPE(UFancyFoldersSubsystem::GetAllPathWidgets)
+	FolderRecords.Reset();
+	RequestRefresh();
+}
 
-	TArray<TSharedRef<SPathView>> Result;
+void UFancyFoldersSubsystem::OnContentPathMountChanged(const FString& AssetPath, const FString& ContentPath)
+{
+	// Mounts change how virtual paths map to package paths
+	FolderRecords.Reset();
+	RequestRefresh();
+}
 
-	TArray<TSharedRef<SWidget>> TopLevelWidgets;
-	TopLevelWidgets.Append(FSlateApplication::Get().GetTopLevelWindows());
+void UFancyFoldersSubsystem::OnAssetPathChanged(const FString& NewPath)
+{
+	RequestRefresh();
+}
 
-	Helpers::IterateOverWidgetsRecursively(
-		TopLevelWidgets,
-		[&Result](const TSharedRef<SWidget>& Widget)
-		{
-			if (Widget->GetType() == TEXT("SPathView"))
-			{
-				Result.Add(StaticCastSharedRef<SPathView>(Widget));
-			}
-		}
-	);
+void UFancyFoldersSubsystem::OnFilterChanged(const FARFilter& NewFilter, bool bIsPrimaryBrowser)
+{
+	RequestRefresh();
+}
 
-	return Result;
+void UFancyFoldersSubsystem::OnSearchBoxChanged(const FText& SearchText, bool bIsPrimaryBrowser)
+{
+	RequestRefresh();
 }
 
-void UFancyFoldersSubsystem::SyncFolderColorData()
+void UFancyFoldersSubsystem::OnSourcesViewChanged(bool bExpanded)
 {
-	TRACE_CPUPROFILER_EVENT_SCOPE(UFancyFoldersSubsystem::SyncFolderColorData)
+	RequestRefresh();
+}
 
-	TMap<FString, FLinearColor> CurrentPathColors;
+void UFancyFoldersSubsystem::OnTabChanged(TSharedPtr<SDockTab> NewTab, TSharedPtr<SDockTab> OldTab)
+{
+	if (!bActive)
 	{
-		TArray<FString> Section;
-		GConfig->GetSection(TEXT("PathColor"), Section, GEditorPerProjectIni);
-
-		for (int32 SectionIndex = 0; SectionIndex < Section.Num(); SectionIndex++)
+		if (IsAnyContentBrowserTabOpen())
 		{
-			FString EntryStr = Section[SectionIndex];
-			EntryStr.TrimStartInline();
+			Activate();
+		}
 
-			FString PathStr;
-			FString ColorStr;
-			if (EntryStr.Split(TEXT("="), &PathStr, &ColorStr))
+		return;
+	}
+
+	bViewsDirty = true;
+	RequestRefresh();
+}
+
+void UFancyFoldersSubsystem::OnWindowBeingDestroyed(const SWindow& Window)
+{
+	bViewsDirty = true;
+	RequestRefresh();
+}
+
+void UFancyFoldersSubsystem::OnFocusChanging(const FFocusEvent& FocusEvent, const FWeakWidgetPath& OldFocusedWidgetPath, const TSharedPtr<SWidget>& OldFocusedWidget, const FWidgetPath& NewFocusedWidgetPath, const TSharedPtr<SWidget>& NewFocusedWidget)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(UFancyFoldersSubsystem::OnFocusChanging)
+
+	static const FName ContentBrowserType = TEXT("SContentBrowser");
+
+	for (int32 WidgetIndex = 0; WidgetIndex < NewFocusedWidgetPath.Widgets.Num(); WidgetIndex++)
+	{
+		const TSharedRef<SWidget>& Widget = NewFocusedWidgetPath.Widgets[WidgetIndex].Widget;
+		if (Widget->GetType() != ContentBrowserType)
+		{
+			continue;
+		}
+
+		const bool bKnownContentBrowser = ContentBrowsers.ContainsByPredicate(
+			[&Widget](const TWeakPtr<SWidget>& ContentBrowser)
+			{
+				return ContentBrowser.HasSameObject(&Widget.Get());
+			}
+		);
+
+		if (!bKnownContentBrowser)
+		{
+			Activate();
+			bViewsDirty = true;
+			RequestRefresh();
+			return;
+		}
+	}
+}
+
+void UFancyFoldersSubsystem::AssignIconAndColor(const FContentBrowserFolder& Folder)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(UFancyFoldersSubsystem::AssignIconAndColor)
+	SCOPE_CYCLE_COUNTER(STAT_FancyFolders_AssignIconAndColor);
+
+	const FFolderRecord* Record = FindOrAddFolderRecord(Folder.FolderPath);
+	if (!Record)
+	{
+		return;
+	}
+
+	FancyFolders::Stats::Add(FancyFolders::Stats::ECounter::FoldersAssigned);
+
+	const TSharedRef<SImage> Image = Folder.FolderImage;
+	const FSlateBrush* Icon = GetIconForFolder(*Record, StateFromFlags(Folder.IsColumnViewNow(), Folder.bIsOpen));
+	const FSlateColor Color = GetColorForFolder(*Record);
+
+	// Setting the same values again would still invalidate the image, so only the changes are pushed
+	FAppliedFolderState& AppliedState = AppliedFolderStates.FindOrAdd(&Image.Get());
+	const bool bKnownImage = AppliedState.FolderImage.HasSameObject(&Image.Get());
+
+	if (!bKnownImage || AppliedState.Icon != Icon)
+	{
+		Image->SetImage(Icon);
+	}
+
+	if (!bKnownImage || AppliedState.Color != Color)
+	{
+		Image->SetColorAndOpacity(Color);
+	}
+
+	AppliedState = {Image, Icon, Color};
+}
+
+const FSlateBrush* UFancyFoldersSubsystem::GetIconForFolder(const FFolderRecord& Record, EFolderState State) const
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(UFancyFoldersSubsystem::GetIconForFolder)
+
+	FFancyFoldersStyle& Style = FFancyFoldersStyle::Get();
+
+	if (Record.ResolvedData.Data)
+	{
+		if (const FSlateBrush* CustomIcon = Style.GetFolderBrush(Record.ResolvedData.IconIndex, State))
+		{
+			return CustomIcon;
+		}
+	}
+
+	return Style.GetDefaultFolderBrush(Record.Kind, State);
+}
+
+FSlateColor UFancyFoldersSubsystem::GetColorForFolder(const FFolderRecord& Record) const
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(UFancyFoldersSubsystem::GetColorForFolder)
+
+	if (Record.ResolvedData.Data)
+	{
+		return Record.ResolvedData.Data->Color;
+	}
+
+	return AssetViewUtils::GetDefaultColor();
+}
+
+const FFolderRecord* UFancyFoldersSubsystem::FindOrAddFolderRecord(const FName& VirtualPath)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(UFancyFoldersSubsystem::FindOrAddFolderRecord)
+
+	FFolderRecord* Record = FolderRecords.Find(VirtualPath);
+	if (!Record)
+	{
+		Record = &FolderRecords.Add(VirtualPath, MakeFolderRecord(VirtualPath));
+	}
+
+	if (!Record->bExists)
+	{
+		return nullptr;
+	}
+
+	// Only the resolved data depends on the rules, the rest of the record stays valid
+	const UFancyFoldersSettings* Settings = GetDefault<UFancyFoldersSettings>();
+	const uint32 RulesGeneration = Settings->GetRulesGeneration();
+	if (Record->RulesGeneration != RulesGeneration)
+	{
+		Record->ResolvedData = Settings->GetResolvedDataForPath(Record->PackagePath);
+		Record->RulesGeneration = RulesGeneration;
+	}
+
+	// Records are only made for folders being drawn, so their icon index is always needed
+	Record->ResolvedData.ResolveIconIndex();
+
+	return Record;
+}
+
+FFolderRecord UFancyFoldersSubsystem::MakeFolderRecord(const FName& VirtualPath)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(UFancyFoldersSubsystem::MakeFolderRecord)
+
+	FFolderRecord Record;
+
+	UContentBrowserDataSubsystem* ContentBrowserData = IContentBrowserDataModule::Get().GetSubsystem();
+	const FContentBrowserItem Item = ContentBrowserData->GetItemAtPath(VirtualPath, EContentBrowserItemTypeFilter::IncludeFolders);
+	if (!Item.IsValid())
+	{
+		return Record;
+	}
+
+	Record.bExists = true;
+
+	FName PackagePath;
+	ContentBrowserData->TryConvertVirtualPath(VirtualPath, PackagePath);
+	Record.PackagePath = PackagePath.ToString();
+
+	if (Helpers::IsItemCodeContent(Item))
+	{
+		Record.Kind = EFolderKind::Code;
+	}
+	else if (Helpers::IsItemDeveloperContent(Item))
+	{
+		Record.Kind = EFolderKind::Developer;
+	}
+
+	return Record;
+}
+
+void UFancyFoldersSubsystem::StartCollection()
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(UFancyFoldersSubsystem::StartCollection)
+
+	bRefreshPending = false;
+
+	PruneAppliedFolderStates();
+	SyncFolderColorData();
+
+	CollectionViews.Reset();
+	CollectionViewIndex = 0;
+	CollectionRowIndex = 0;
+
+	GatherAssetViewLists();
+	GatherPathViewTrees();
+
+	// The cursor moved since the folders still pending were queued, destroyed images are dropped on the way
+	const FVector2D CursorPosition = FSlateApplication::Get().GetCursorPos();
+
+	PendingImages.Reset();
+	for (int32 PendingIndex = PendingFolders.Num() - 1; PendingIndex >= 0; PendingIndex--)
+	{
+		FPendingContentBrowserFolder& PendingFolder = PendingFolders[PendingIndex];
+		const TSharedPtr<SImage> FolderImage = PendingFolder.FolderImage.Pin();
+		if (!FolderImage)
+		{
+			PendingFolders.RemoveAtSwap(PendingIndex, EAllowShrinking::No);
+			continue;
+		}
+
+		PendingFolder.Priority = GetFolderPriority(*FolderImage, CursorPosition);
+		PendingImages.Add(FolderImage.Get());
+	}
+
+	PendingFolders.Heapify(Helpers::FCloserToCursor());
+}
+
+void UFancyFoldersSubsystem::CollectFolders(double EndTime)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(UFancyFoldersSubsystem::CollectFolders)
+
+	while (IsCollecting())
+	{
+		const FCollectedTableView& CollectedView = CollectionViews[CollectionViewIndex];
+
+		// Only the rows currently generated by the view can be on screen, collapsed and scrolled out folders are skipped
+		const TSharedPtr<STableViewBase> TableView = CollectedView.TableView.Pin();
+		FChildren* Rows = TableView ? Helpers::AccessTableView(*TableView).GetGeneratedRows() : nullptr;
+		if (!Rows || CollectionRowIndex >= Rows->Num())
+		{
+			CollectionViewIndex++;
+			CollectionRowIndex = 0;
+			continue;
+		}
+
+		const TSharedRef<SWidget> RowWidget = Rows->GetChildAt(CollectionRowIndex++);
+		if (CollectedView.bIsPathTree)
+		{
+			CollectPathViewRow(static_cast<const FPathTreeView&>(*TableView), RowWidget);
+		}
+		else
+		{
+			CollectAssetViewRow(RowWidget);
+		}
+
+		// Out of time, the next frame resumes from the next row
+		if (FPlatformTime::Seconds() >= EndTime)
+		{
+			return;
+		}
+	}
+}
+
+void UFancyFoldersSubsystem::GatherAssetViewLists()
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(UFancyFoldersSubsystem::GatherAssetViewLists)
+
+	static const FName AssetTileViewType = TEXT("SAssetTileView");
+	static const FName AssetListViewType = TEXT("SAssetListView");
+	static const FName AssetColumnViewType = TEXT("SAssetColumnView");
+
+	TArray<TSharedRef<SWidget>> AssetViewWidgets = TArray<TSharedRef<SWidget>>(GetAllAssetViews());
+
+	FancyFolders::VisitWidgets(
+		AssetViewWidgets,
+		{},
+		[this](const TSharedRef<SWidget>& Widget)
+		{
+			const FName WidgetType = Widget->GetType();
+			if (WidgetType != AssetTileViewType && WidgetType != AssetListViewType && WidgetType != AssetColumnViewType)
+			{
+				return FancyFolders::EWidgetQueryResult::Continue;
+			}
+
+			const TSharedRef<STableViewBase> TableView = StaticCastSharedRef<STableViewBase>(Widget);
+			HookTableViewScrolling(TableView);
+			CollectionViews.Add({TableView, false});
+
+			// The rows are collected over the next frames
+			return FancyFolders::EWidgetQueryResult::SkipChildren;
+		}
+	);
+}
+
+void UFancyFoldersSubsystem::GatherPathViewTrees()
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(UFancyFoldersSubsystem::GatherPathViewTrees)
+
+#if UE_VERSION_NEWER_THAN(5, 4, 4)
+	const FName PathWidgetType = TEXT("STreeView<TSharedPtr<FTreeItem>>");
+#else
+	const FName PathWidgetType =  TEXT("STreeView< TSharedPtr<FTreeItem> >");
+#endif
+
+	TArray<TSharedRef<SPathView>> PathWidgets = GetAllPathWidgets();
+	for (const TSharedRef<SPathView>& PathWidget : PathWidgets)
+	{
+		const TSharedPtr<FPathTreeView> TreeViewPtr = FancyFolders::FindChildWidgetOfType<FPathTreeView>(PathWidget, PathWidgetType);
+		if (!TreeViewPtr)
+		{
+			continue;
+		}
+
+		HookPathTreeExpansion(TreeViewPtr.ToSharedRef());
+		HookTableViewScrolling(TreeViewPtr.ToSharedRef());
+		CollectionViews.Add({TreeViewPtr, true});
+	}
+}
+
+void UFancyFoldersSubsystem::CollectAssetViewRow(const TSharedRef<SWidget>& RowWidget)
+{
+	FancyFolders::VisitWidgets(
+		MakeArrayView(&RowWidget, 1),
+		{},
+		[this](const TSharedRef<SWidget>& Widget)
+		{
+			const TSharedPtr<FTagMetaData> MetaTag = Widget->GetMetaData<FTagMetaData>();
+			if (!MetaTag)
+			{
+				return FancyFolders::EWidgetQueryResult::Continue;
+			}
+
+			const FName& PathTag = MetaTag->Tag;
+			// TODO: Find a better way to confirm this is a virtual path
+			const FNameBuilder PathTagBuilder(PathTag);
+			if (!PathTagBuilder.ToView().StartsWith(TEXT('/')))
+			{
+				return FancyFolders::EWidgetQueryResult::Continue;
+			}
+
+			if (const TSharedPtr<SImage> FoundImage = FancyFolders::FindChildWidgetOfType<SImage>(Widget))
+			{
+				FContentBrowserFolder Folder = {PathTag, FoundImage.ToSharedRef()};
+				QueueFolder(Folder);
+			}
+
+			// Each row shows a single item
+			return FancyFolders::EWidgetQueryResult::Stop;
+		}
+	);
+}
+
+void UFancyFoldersSubsystem::CollectPathViewRow(const FPathTreeView& TreeView, const TSharedRef<SWidget>& RowWidget)
+{
+#if UE_VERSION_NEWER_THAN(5, 4, 4)
+	static const FName PathRowType = TEXT("STableRow<TSharedPtr<FTreeItem>>");
+#else
+	static const FName PathRowType = TEXT("STableRow< TSharedPtr<FTreeItem> >");
+#endif
+
+	// SPathView::GenerateTreeRow makes plain STableRows, anything else can't safely be cast to an ITableRow
+	if (RowWidget->GetType() != PathRowType)
+	{
+		return;
+	}
+
+	const ITableRow& Row = static_cast<STableRow<TSharedPtr<FTreeItem>>&>(RowWidget.Get());
+	if (const TOptional<FContentBrowserFolder> Folder = GetPathTreeRowFolder(TreeView, Row))
+	{
+		QueueFolder(*Folder);
+	}
+}
+
+TOptional<FContentBrowserFolder> UFancyFoldersSubsystem::GetPathTreeRowFolder(const FPathTreeView& TreeView, const ITableRow& Row)
+{
+	const TSharedPtr<FTreeItem>* Item = TreeView.ItemFromWidget(&Row);
+	if (!Item || !Item->IsValid())
+	{
+		return {};
+	}
+
+	const TSharedPtr<SWidget> RowContent = const_cast<ITableRow&>(Row).GetContent();
+	if (!RowContent)
+	{
+		return {};
+	}
+
+	const TSharedPtr<SImage> FoundImage = FancyFolders::FindChildWidgetOfType<SImage>(RowContent.ToSharedRef());
+	if (!FoundImage)
+	{
+		return {};
+	}
+
+	return FContentBrowserFolder{(*Item)->GetItem().GetVirtualPath(), FoundImage.ToSharedRef(), TreeView.IsItemExpanded(*Item)};
+}
+
+void UFancyFoldersSubsystem::HookPathTreeExpansion(const TSharedRef<FPathTreeView>& TreeView)
+{
+	HookedPathTrees.RemoveAll(
+		[](const FHookedPathTree& Hook)
+		{
+			return !Hook.TreeView.IsValid();
+		}
+	);
+
+	const bool bAlreadyHooked = HookedPathTrees.ContainsByPredicate(
+		[&TreeView](const FHookedPathTree& Hook)
+		{
+			return Hook.TreeView.HasSameObject(&TreeView.Get());
+		}
+	);
+
+	if (bAlreadyHooked)
+	{
+		return;
+	}
+
+	FOnPathTreeExpansionChanged& OnExpansionChanged = Helpers::AccessPathTreeView(*TreeView).AccessOnExpansionChanged();
+	HookedPathTrees.Add({TreeView, OnExpansionChanged});
+	OnExpansionChanged = FOnPathTreeExpansionChanged::CreateUObject(this, &ThisClass::OnPathTreeExpansionChanged, TWeakPtr<FPathTreeView>(TreeView));
+}
+
+void UFancyFoldersSubsystem::UnhookPathTrees()
+{
+	for (const FHookedPathTree& Hook : HookedPathTrees)
+	{
+		if (const TSharedPtr<FPathTreeView> TreeView = Hook.TreeView.Pin())
+		{
+			Helpers::AccessPathTreeView(*TreeView).AccessOnExpansionChanged() = Hook.OriginalDelegate;
+		}
+	}
+
+	HookedPathTrees.Reset();
+}
+
+void UFancyFoldersSubsystem::OnPathTreeExpansionChanged(TSharedPtr<FTreeItem> Item, bool bIsExpanded, TWeakPtr<FPathTreeView> WeakTreeView)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(UFancyFoldersSubsystem::OnPathTreeExpansionChanged)
+
+	const TSharedPtr<FPathTreeView> TreeView = WeakTreeView.Pin();
+	if (!TreeView)
+	{
+		return;
+	}
+
+	// The path view still has to save it's expansion state
+	const FHookedPathTree* Hook = HookedPathTrees.FindByPredicate(
+		[&TreeView](const FHookedPathTree& Other)
+		{
+			return Other.TreeView.HasSameObject(TreeView.Get());
+		}
+	);
+
+	if (Hook)
+	{
+		Hook->OriginalDelegate.ExecuteIfBound(Item, bIsExpanded);
+	}
+
+	// Only the toggled folder swaps it's icon right away, the rows generated for it's children are picked up by the refresh
+	if (const TSharedPtr<ITableRow> Row = TreeView->WidgetFromItem(Item))
+	{
+		if (TOptional<FContentBrowserFolder> Folder = GetPathTreeRowFolder(*TreeView, *Row))
+		{
+			Folder->bIsOpen = bIsExpanded;
+			AssignIconAndColor(*Folder);
+		}
+	}
+
+	RequestRefresh();
+}
+
+void UFancyFoldersSubsystem::HookTableViewScrolling(const TSharedRef<STableViewBase>& TableView)
+{
+	HookedTableViews.RemoveAll(
+		[](const FHookedTableView& Hook)
+		{
+			return !Hook.TableView.IsValid();
+		}
+	);
+
+	const bool bAlreadyHooked = HookedTableViews.ContainsByPredicate(
+		[&TableView](const FHookedTableView& Hook)
+		{
+			return Hook.TableView.HasSameObject(&TableView.Get());
+		}
+	);
+
+	if (bAlreadyHooked)
+	{
+		return;
+	}
+
+	FOnTableViewScrolled& OnScrolled = Helpers::AccessTableView(*TableView).AccessOnTableViewScrolled();
+	HookedTableViews.Add({TableView, OnScrolled});
+	OnScrolled = FOnTableViewScrolled::CreateUObject(this, &ThisClass::OnTableViewScrolled, TWeakPtr<STableViewBase>(TableView));
+}
+
+void UFancyFoldersSubsystem::UnhookTableViews()
+{
+	for (const FHookedTableView& Hook : HookedTableViews)
+	{
+		if (const TSharedPtr<STableViewBase> TableView = Hook.TableView.Pin())
+		{
+			Helpers::AccessTableView(*TableView).AccessOnTableViewScrolled() = Hook.OriginalDelegate;
+		}
+	}
+
+	HookedTableViews.Reset();
+}
+
+void UFancyFoldersSubsystem::OnTableViewScrolled(double ScrollOffset, TWeakPtr<STableViewBase> WeakTableView)
+{
+	const TSharedPtr<STableViewBase> TableView = WeakTableView.Pin();
+	if (!TableView)
+	{
+		return;
+	}
+
+	const FHookedTableView* Hook = HookedTableViews.FindByPredicate(
+		[&TableView](const FHookedTableView& Other)
+		{
+			return Other.TableView.HasSameObject(TableView.Get());
+		}
+	);
+
+	if (Hook)
+	{
+		Hook->OriginalDelegate.ExecuteIfBound(ScrollOffset);
+	}
+
+	// Scrolling generates rows for the folders coming into view
+	RequestRefresh();
+}
+
+void UFancyFoldersSubsystem::QueueFolder(const FContentBrowserFolder& Folder)
+{
+	// A folder still waiting from an earlier pass keeps it's entry, it's priority was refreshed when this pass started
+	bool bAlreadyPending = false;
+	PendingImages.Add(&Folder.FolderImage.Get(), &bAlreadyPending);
+	if (bAlreadyPending)
+	{
+		return;
+	}
+
+	const double Priority = GetFolderPriority(*Folder.FolderImage, FSlateApplication::Get().GetCursorPos());
+	PendingFolders.HeapPush({Folder.FolderPath, Folder.FolderImage, Folder.bIsOpen, Priority}, Helpers::FCloserToCursor());
+}
+
+double UFancyFoldersSubsystem::GetFolderPriority(const SImage& FolderImage, const FVector2D& CursorPosition)
+{
+	const FGeometry& Geometry = FolderImage.GetTickSpaceGeometry();
+
+	// Images which were never arranged are not on screen yet, so they go last
+	if (Geometry.GetLocalSize().X <= 0.0 || Geometry.GetLocalSize().Y <= 0.0)
+	{
+		return TNumericLimits<double>::Max();
+	}
+
+	const FVector2D ImageCenter = Geometry.GetAbsolutePositionAtCoordinates(FVector2D(0.5, 0.5));
+	return FVector2D::DistSquared(ImageCenter, CursorPosition);
+}
+
+void UFancyFoldersSubsystem::ProcessPendingFolders(double EndTime)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(UFancyFoldersSubsystem::ProcessPendingFolders)
+
+	if (PendingFolders.IsEmpty())
+	{
+		return;
+	}
+
+	// At least one folder is processed each frame, so even tiny budgets make progress
+	do
+	{
+		FPendingContentBrowserFolder PendingFolder;
+		PendingFolders.HeapPop(PendingFolder, Helpers::FCloserToCursor(), EAllowShrinking::No);
+
+		if (const TSharedPtr<SImage> FolderImage = PendingFolder.FolderImage.Pin())
+		{
+			PendingImages.Remove(FolderImage.Get());
+
+			const FContentBrowserFolder Folder = {PendingFolder.FolderPath, FolderImage.ToSharedRef(), PendingFolder.bIsOpen};
+			AssignIconAndColor(Folder);
+		}
+	}
+	while (!PendingFolders.IsEmpty() && FPlatformTime::Seconds() < EndTime);
+}
+
+void UFancyFoldersSubsystem::PruneAppliedFolderStates()
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(UFancyFoldersSubsystem::PruneAppliedFolderStates)
+
+	for (auto It = AppliedFolderStates.CreateIterator(); It; ++It)
+	{
+		if (!It->Value.FolderImage.IsValid())
+		{
+			It.RemoveCurrent();
+		}
+	}
+}
+
+void UFancyFoldersSubsystem::DiscoverViews()
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(UFancyFoldersSubsystem::DiscoverViews)
+	SCOPE_CYCLE_COUNTER(STAT_FancyFolders_DiscoverViews);
+
+	static const FName ContentBrowserType = TEXT("SContentBrowser");
+	static const FName AssetViewType = TEXT("SAssetView");
+	static const FName PathViewType = TEXT("SPathView");
+
+	ContentBrowsers.Reset();
+	AssetViews.Reset();
+	PathViews.Reset();
+
+	TArray<TSharedRef<SWidget>> TopLevelWidgets;
+	TopLevelWidgets.Append(FSlateApplication::Get().GetTopLevelWindows());
+
+	// Hidden views are registered as well, they can become visible without any window or tab change
+	FancyFolders::FWidgetQuery Query;
+	Query.bSkipHiddenWidgets = false;
+	Query.bIncludeChildWindows = true;
+
+	FancyFolders::VisitWidgets(
+		TopLevelWidgets,
+		Query,
+		[this](const TSharedRef<SWidget>& Widget)
+		{
+			const FName WidgetType = Widget->GetType();
+			if (WidgetType == ContentBrowserType)
+			{
+				ContentBrowsers.Add(Widget);
+			}
+			else if (WidgetType == AssetViewType)
 			{
-				FLinearColor CurrentColor;
-				if (CurrentColor.InitFromString(ColorStr))
-				{
-					CurrentPathColors.Emplace(PathStr, CurrentColor);
-				}
+				AssetViews.Add(StaticCastSharedRef<SAssetView>(Widget));
+				return FancyFolders::EWidgetQueryResult::SkipChildren;
+			}
+			else if (WidgetType == PathViewType)
+			{
+				PathViews.Add(StaticCastSharedRef<SPathView>(Widget));
+				return FancyFolders::EWidgetQueryResult::SkipChildren;
+			}
+
+			return FancyFolders::EWidgetQueryResult::Continue;
+		}
+	);
+
+	bViewsDirty = false;
+}
+
+TArray<TSharedRef<SAssetView>> UFancyFoldersSubsystem::GetAllAssetViews() const
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(UFancyFoldersSubsystem::GetAllAssetViews)
+
+	TArray<TSharedRef<SAssetView>> Result;
+	for (const TWeakPtr<SAssetView>& AssetView : AssetViews)
+	{
+		const TSharedPtr<SAssetView> AssetViewPtr = AssetView.Pin();
+		if (AssetViewPtr.IsValid() && IsViewOnScreen(AssetViewPtr.ToSharedRef()))
+		{
+			Result.Add(AssetViewPtr.ToSharedRef());
+		}
+	}
+
+	return Result;
+}
+
+TArray<TSharedRef<SPathView>> UFancyFoldersSubsystem::GetAllPathWidgets() const
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(UFancyFoldersSubsystem::GetAllPathWidgets)
+
+	TArray<TSharedRef<SPathView>> Result;
+	for (const TWeakPtr<SPathView>& PathView : PathViews)
+	{
+		const TSharedPtr<SPathView> PathViewPtr = PathView.Pin();
+		if (PathViewPtr.IsValid() && IsViewOnScreen(PathViewPtr.ToSharedRef()))
+		{
+			Result.Add(PathViewPtr.ToSharedRef());
+		}
+	}
+
+	return Result;
+}
+
+void UFancyFoldersSubsystem::SyncFolderColorData()
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(UFancyFoldersSubsystem::SyncFolderColorData)
+
+	// The section rarely changes, only parse it once it's content differs from the last sync
+	const uint32 PathColorsHash = HashPathColorSection();
+	if (PathColorsHash == CachedPathColorsHash)
+	{
+		return;
+	}
+
+	CachedPathColorsHash = PathColorsHash;
+
+	TArray<FString> Section;
+	GConfig->GetSection(TEXT("PathColor"), Section, GEditorPerProjectIni);
+
+	ApplyPathColorSection(Section, CachedPathColors, GetMutableDefault<UFancyFoldersSettings>());
+}
+
+void UFancyFoldersSubsystem::ApplyPathColorSection(const TArray<FString>& Section, TMap<FString, FLinearColor>& CachedPathColors, UFancyFoldersSettings* Settings)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(UFancyFoldersSubsystem::ApplyPathColorSection)
+
+	TMap<FString, FLinearColor> CurrentPathColors;
+	for (int32 SectionIndex = 0; SectionIndex < Section.Num(); SectionIndex++)
+	{
+		FString EntryStr = Section[SectionIndex];
+		EntryStr.TrimStartInline();
+
+		FString PathStr;
+		FString ColorStr;
+		if (EntryStr.Split(TEXT("="), &PathStr, &ColorStr))
+		{
+			FLinearColor CurrentColor;
+			if (CurrentColor.InitFromString(ColorStr))
+			{
+				CurrentPathColors.Emplace(PathStr, CurrentColor);
 			}
 		}
 	}
@@ -466,7 +1328,8 @@ void UFancyFoldersSubsystem::SyncFolderColorData()
 	TArray<TTuple<FString, FLinearColor>> NewColors = Helpers::GetDifference(CurrentPathColors, CachedPathColors, true);
 	TArray<TTuple<FString, FLinearColor>> RemovedColors = Helpers::GetDifference(CachedPathColors, CurrentPathColors, false);
 
-	UFancyFoldersSettings* Settings = GetMutableDefault<UFancyFoldersSettings>();
+	FScopedFancyFoldersBatch Batch(Settings);
+
 	for (auto Color : NewColors)
 	{
 		Settings->UpdateOrCreateAssignmentColor(Color.Key, Color.Value);
@@ -477,30 +1340,128 @@ void UFancyFoldersSubsystem::SyncFolderColorData()
 		Settings->UpdateOrCreateAssignmentColor(Color.Key, {});
 	}
 
-	CachedPathColors = CurrentPathColors;
+	CachedPathColors = MoveTemp(CurrentPathColors);
+}
+
+void UFancyFoldersSubsystem::ApplyPathColors(TConstArrayView<FString> Folders, TOptional<FLinearColor> Color)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(UFancyFoldersSubsystem::ApplyPathColors)
+
+	// Picks up any outside change first, so it isn't hidden by the hash update below
+	SyncFolderColorData();
+
+	for (const FString& Folder : Folders)
+	{
+		AssetViewUtils::SetPathColor(Folder, Color);
+
+		if (Color)
+		{
+			CachedPathColors.Add(Folder, *Color);
+		}
+		else
+		{
+			CachedPathColors.Remove(Folder);
+		}
+	}
+
+	// The settings already hold these colors, reading them back would only rewrite the same assignments
+	CachedPathColorsHash = HashPathColorSection();
+}
+
+uint32 UFancyFoldersSubsystem::HashPathColorSection()
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(UFancyFoldersSubsystem::HashPathColorSection)
+
+	const FConfigSection* Section = GConfig->GetSection(TEXT("PathColor"), false, GEditorPerProjectIni);
+	if (!Section)
+	{
+		return 0;
+	}
+
+	// Hashes the entries in place, so an unchanged section costs no allocation
+	uint32 Hash = Section->Num();
+	for (const TPair<FName, FConfigValue>& Entry : *Section)
+	{
+		Hash = HashCombineFast(Hash, GetTypeHash(Entry.Key));
+		Hash = HashCombineFast(Hash, FCrc::StrCrc32(*Entry.Value.GetSavedValue()));
+	}
+
+	return Hash;
 }
 
 bool UFancyFoldersSubsystem::ShouldUpdateContentBrowsers() const
 {
 	TRACE_CPUPROFILER_EVENT_SCOPE(UFancyFoldersSubsystem::ShouldUpdateContentBrowsers)
 
-	FWorldContext* PIEWorldContext = GUnrealEd->GetPIEWorldContext();
-	if(!PIEWorldContext || PIEWorldContext->WorldType != EWorldType::PIE)
+	if (!GEditor->IsPlaySessionInProgress())
 	{
 		return true;
 	}
 
-	bool bContentBrowserFocused = false;
+	// While playing only the content browser under the cursor is refreshed, found by comparing the widgets instead of their names
+	const FWeakWidgetPath& WidgetsUnderCursor = FSlateApplication::Get().GetCursorUser()->GetLastWidgetsUnderCursor();
+	for (int32 WidgetIndex = WidgetsUnderCursor.Widgets.Num() - 1; WidgetIndex >= 0; --WidgetIndex)
+	{
+		const TSharedPtr<SWidget> Widget = WidgetsUnderCursor.Widgets[WidgetIndex].Pin();
+		if (!Widget.IsValid())
+		{
+			continue;
+		}
 
-	FSlateApplication& App = FSlateApplication::Get();
-	FWidgetPath UserFocusedPath = App.GetCursorUser()->GetLastWidgetsUnderCursor().ToWidgetPath();
-	
-	for (int32 WidgetIndex = UserFocusedPath.Widgets.Num() - 1; WidgetIndex >= 0; --WidgetIndex)
+		const bool bIsAssetView = AssetViews.ContainsByPredicate(
+			[&Widget](const TWeakPtr<SAssetView>& AssetView)
+			{
+				return AssetView.HasSameObject(Widget.Get());
+			}
+		);
+
+		const bool bIsPathView = PathViews.ContainsByPredicate(
+			[&Widget](const TWeakPtr<SPathView>& PathView)
+			{
+				return PathView.HasSameObject(Widget.Get());
+			}
+		);
+
+		if (bIsAssetView || bIsPathView)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+bool UFancyFoldersSubsystem::IsRefreshSuspended() const
+{
+	const UFancyFoldersSettings* Settings = GetDefault<UFancyFoldersSettings>();
+
+	if (Settings->SuspendDuringPIE() && GEditor->IsPlaySessionInProgress())
 	{
-		const FArrangedWidget& CurrentWidget = UserFocusedPath.Widgets[WidgetIndex];
-		const FString CurrentWidgetType = CurrentWidget.Widget->ToString();
-		bContentBrowserFocused |= CurrentWidgetType.Contains(TEXT("ContentBrowser"));
+		return true;
+	}
+
+	return !Settings->RefreshWhileUnfocused() && !FSlateApplication::Get().IsActive();
+}
+
+bool UFancyFoldersSubsystem::IsViewOnScreen(const TSharedRef<SWidget>& View)
+{
+	// Background tabs and collapsed drawers detach their content, so the view never reaches a window
+	TSharedPtr<SWidget> Widget = View;
+	while (Widget.IsValid())
+	{
+		if (Widget->Advanced_IsWindow())
+		{
+			const SWindow& Window = static_cast<const SWindow&>(*Widget);
+			return Window.IsVisible() && !Window.IsWindowMinimized();
+		}
+
+		if (!Widget->GetVisibility().IsVisible())
+		{
+			return false;
+		}
+
+		Widget = Widget->GetParentWidget();
 	}
 
-	return bContentBrowserFocused;
+	return false;
 }
@@ -0,0 +1,82 @@
+﻿// Copyright Out-of-the-Box Plugins 2018-2025. All Rights Reserved.
+
+#include "FancyFoldersWidgetQuery.h"
+
+#include <Widgets/SWindow.h>
+
+#include "FancyFoldersStats.h"
+
+namespace FancyFolders
+{
+	namespace Private
+	{
+		bool VisitWidgetRecursively(const TSharedRef<SWidget>& Widget, int32 Depth, const FWidgetQuery& Query, FWidgetVisitor Visitor, int32& NumVisited)
+		{
+			if (Query.bSkipHiddenWidgets && !Widget->GetVisibility().IsVisible())
+			{
+				return true;
+			}
+
+			NumVisited++;
+
+			const EWidgetQueryResult Result = Visitor(Widget);
+			if (Result == EWidgetQueryResult::Stop)
+			{
+				return false;
+			}
+
+			if (Result == EWidgetQueryResult::SkipChildren || (Query.MaxDepth != INDEX_NONE && Depth >= Query.MaxDepth))
+			{
+				return true;
+			}
+
+			if (Query.bIncludeChildWindows && Widget->GetType() == GetWidgetTypeName<SWindow>())
+			{
+				const TSharedRef<SWindow> WidgetAsWindow = StaticCastSharedRef<SWindow>(Widget);
+				for (const TSharedRef<SWindow>& ChildWindow : WidgetAsWindow->GetChildWindows())
+				{
+					if (!VisitWidgetRecursively(ChildWindow, Depth + 1, Query, Visitor, NumVisited))
+					{
+						return false;
+					}
+				}
+			}
+
+			FChildren* Children = Widget->GetChildren();
+			if (!Children)
+			{
+				return true;
+			}
+
+			for (int32 ChildIndex = 0; ChildIndex < Children->Num(); ChildIndex++)
+			{
+				if (!VisitWidgetRecursively(Children->GetChildAt(ChildIndex), Depth + 1, Query, Visitor, NumVisited))
+				{
+					return false;
+				}
+			}
+
+			return true;
+		}
+	} // namespace Private
+
+	bool VisitWidgets(TConstArrayView<TSharedRef<SWidget>> Roots, const FWidgetQuery& Query, FWidgetVisitor Visitor)
+	{
+		TRACE_CPUPROFILER_EVENT_SCOPE(FancyFolders::VisitWidgets)
+
+		int32 NumVisited = 0;
+		bool bCompleted = true;
+
+		for (const TSharedRef<SWidget>& Root : Roots)
+		{
+			if (!Private::VisitWidgetRecursively(Root, 0, Query, Visitor, NumVisited))
+			{
+				bCompleted = false;
+				break;
+			}
+		}
+
+		Stats::Add(Stats::ECounter::WidgetsVisited, NumVisited);
+		return bCompleted;
+	}
+} // namespace FancyFolders
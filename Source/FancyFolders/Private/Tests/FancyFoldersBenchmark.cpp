@@ -0,0 +1,516 @@
+﻿// Copyright Out-of-the-Box Plugins 2018-2025. All Rights Reserved.
+
+#include <HAL/LowLevelMemTracker.h>
+#include <HAL/MemoryBase.h>
+#include <Math/RandomStream.h>
+#include <Misc/AutomationTest.h>
+#include <Misc/FileHelper.h>
+#include <Misc/Paths.h>
+#include <Policies/PrettyJsonPrintPolicy.h>
+#include <Serialization/JsonWriter.h>
+
+#include "FancyFolders.h"
+#include "FancyFoldersSettings.h"
+#include "FancyFoldersSubsystem.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace BenchmarkHelpers
+{
+	/**
+	 * LLM tag the measured operations allocate under
+	 */
+	const TCHAR* const LLMTagName = TEXT("FancyFolders/Benchmark");
+
+#if STATS
+	/**
+	 * Exposes the allocator call counters FMalloc only keeps in stats builds
+	 */
+	class FMallocCallCounters : public FMalloc
+	{
+	public:
+		/**
+		 * Returns the number of Malloc and Realloc calls made so far, by any thread
+		 */
+		static uint64 GetNumAllocations()
+		{
+			const uint64 NumMallocCalls = TotalMallocCalls;
+			const uint64 NumReallocCalls = TotalReallocCalls;
+			return NumMallocCalls + NumReallocCalls;
+		}
+	};
+#endif
+
+	/**
+	 * Returns true if the bytes allocated under the LLM tag can be measured, which requires running the editor with -llm
+	 */
+	bool HasTrackedBytes()
+	{
+#if ENABLE_LOW_LEVEL_MEM_TRACKER
+		return FLowLevelMemTracker::IsEnabled();
+#else
+		return false;
+#endif
+	}
+
+	/**
+	 * Returns the bytes currently allocated under the benchmark's LLM tag, 0 if HasTrackedBytes is false
+	 */
+	int64 GetTrackedBytes()
+	{
+#if ENABLE_LOW_LEVEL_MEM_TRACKER
+		if (FLowLevelMemTracker::IsEnabled())
+		{
+			// The amounts of each thread are only gathered once per frame otherwise
+			FLowLevelMemTracker::Get().UpdateStatsPerFrame();
+			return FLowLevelMemTracker::Get().GetTagAmountForTracker(ELLMTracker::Default, FName(LLMTagName), ELLMTagSet::None);
+		}
+#endif
+
+		return 0;
+	}
+
+	/**
+	 * Returns true if allocations can be counted, which requires a build with stats
+	 */
+	constexpr bool HasAllocationCounts()
+	{
+		return STATS != 0;
+	}
+
+	/**
+	 * Returns the number of allocations made so far by the whole process, 0 if HasAllocationCounts is false
+	 */
+	int64 GetAllocationCount()
+	{
+#if STATS
+		return static_cast<int64>(FMallocCallCounters::GetNumAllocations());
+#else
+		return 0;
+#endif
+	}
+
+	/**
+	 * Returns a random folder path, between 1 and 6 folders deep under /Game
+	 */
+	FString MakeFolderPath(FRandomStream& Random)
+	{
+		static const TCHAR* RootFolders[] = {TEXT("Art"), TEXT("Audio"), TEXT("Blueprints"), TEXT("Maps"), TEXT("Materials"), TEXT("Textures"), TEXT("UI"), TEXT("VFX")};
+
+		FString Path = FString::Printf(TEXT("/Game/%s"), RootFolders[Random.RandHelper(UE_ARRAY_COUNT(RootFolders))]);
+
+		const int32 Depth = Random.RandRange(1, 6);
+		for (int32 Level = 1; Level < Depth; Level++)
+		{
+			Path += FString::Printf(TEXT("/Folder_%d"), Random.RandHelper(64));
+		}
+
+		return Path;
+	}
+
+	/**
+	 * Returns NumPaths different random folder paths
+	 */
+	TArray<FString> MakeUniqueFolderPaths(FRandomStream& Random, int32 NumPaths)
+	{
+		TSet<FString> Paths;
+		Paths.Reserve(NumPaths);
+
+		while (Paths.Num() < NumPaths)
+		{
+			Paths.Add(MakeFolderPath(Random));
+		}
+
+		return Paths.Array();
+	}
+
+	/**
+	 * Returns a random icon among the ones on disk, with a random color
+	 */
+	FFolderData MakeFolderData(FRandomStream& Random)
+	{
+		const TArray<FString>& IconNames = FFancyFoldersModule::GetIconManifest().IconNames;
+		const FName Icon = IconNames.IsEmpty() ? FName("Default") : FName(*IconNames[Random.RandHelper(IconNames.Num())]);
+		return {Icon, FLinearColor(Random.FRand(), Random.FRand(), Random.FRand())};
+	}
+
+	/**
+	 * Returns a comma separated list of sizes from the command line, or the defaults if it's missing
+	 */
+	TArray<int32> ParseSizes(const TCHAR* Key, const TArray<int32>& Defaults)
+	{
+		FString Value;
+		if (!FParse::Value(FCommandLine::Get(), Key, Value, false))
+		{
+			return Defaults;
+		}
+
+		TArray<FString> Entries;
+		Value.ParseIntoArray(Entries, TEXT(","));
+
+		TArray<int32> Result;
+		for (const FString& Entry : Entries)
+		{
+			Result.Add(FMath::Max(FCString::Atoi(*Entry), 1));
+		}
+
+		return Result.IsEmpty() ? Defaults : Result;
+	}
+} // namespace BenchmarkHelpers
+
+/**
+ * Measures the rule engine on synthetic settings, without touching the project's settings or config files
+ */
+class FFancyFoldersBenchmark
+{
+public:
+	/**
+	 * Sizes of the synthetic data used by a single run
+	 */
+	struct FConfig
+	{
+		int32 NumAssignments = 0;
+		int32 NumPresets = 0;
+		int32 NumPaths = 0;
+	};
+	/**
+	 * Measurement of a single operation
+	 */
+	struct FResult
+	{
+		FString Operation;
+		FConfig Config;
+		int32 NumOps = 0;
+		double Seconds = 0.0;
+		int64 NumBytes = 0;
+		int64 NumAllocations = 0;
+	};
+	/**
+	 * Generates the synthetic settings for the config and measures every operation on them
+	 */
+	static void RunConfig(const FConfig& Config, TArray<FResult>& OutResults);
+	/**
+	 * Returns the results formatted as a JSON document
+	 */
+	static FString ToJson(const TArray<FResult>& Results);
+};
+
+void FFancyFoldersBenchmark::RunConfig(const FConfig& Config, TArray<FResult>& OutResults)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FFancyFoldersBenchmark::RunConfig)
+
+	FRandomStream Random(Config.NumAssignments ^ (Config.NumPresets << 20) ^ Config.NumPaths);
+
+	// A transient instance is never written to the config file
+	UFancyFoldersSettings* Settings = NewObject<UFancyFoldersSettings>(GetTransientPackage(), NAME_None, RF_Transient);
+
+	const TArray<FString> AssignedPaths = BenchmarkHelpers::MakeUniqueFolderPaths(Random, Config.NumAssignments);
+
+	Settings->PathAssignments.Reset(AssignedPaths.Num());
+	for (const FString& Path : AssignedPaths)
+	{
+		Settings->PathAssignments.Add({Path, BenchmarkHelpers::MakeFolderData(Random), Random.FRand() < 0.1f});
+	}
+
+	// Every kind of pattern the rules know about, so both the literal matching and ICU are part of the measurements
+	Settings->FolderPresets.Reset();
+	Settings->PathPresets.Reset();
+	for (int32 PresetIndex = 0; PresetIndex < Config.NumPresets; PresetIndex++)
+	{
+		const int32 Folder = Random.RandHelper(64);
+		switch (PresetIndex % 6)
+		{
+		case 0:
+			Settings->FolderPresets.Add({FString::Printf(TEXT("^Folder_%d$"), Folder), BenchmarkHelpers::MakeFolderData(Random)});
+			break;
+		case 1:
+			Settings->FolderPresets.Add({FString::Printf(TEXT("Folder_%d*"), Folder), BenchmarkHelpers::MakeFolderData(Random)});
+			break;
+		case 2:
+			Settings->FolderPresets.Add({FString::Printf(TEXT("^(Folder_%d|Folder_%d)$"), Folder, PresetIndex), BenchmarkHelpers::MakeFolderData(Random)});
+			break;
+		case 3:
+			Settings->PathPresets.Add({FString::Printf(TEXT("^%s/"), *BenchmarkHelpers::MakeFolderPath(Random)), BenchmarkHelpers::MakeFolderData(Random)});
+			break;
+		case 4:
+			Settings->PathPresets.Add({FString::Printf(TEXT("/Folder_%d/Folder_%d$"), Folder, PresetIndex % 64), BenchmarkHelpers::MakeFolderData(Random)});
+			break;
+		default:
+			Settings->PathPresets.Add({FString::Printf(TEXT("^/Game/.*/Folder_%d/.*Folder_[0-%d]$"), Folder, PresetIndex % 10), BenchmarkHelpers::MakeFolderData(Random)});
+			break;
+		}
+	}
+
+	// A quarter of the looked up paths are assigned ones, the rest only go through the inherited assignments and presets
+	TArray<FString> LookupPaths = BenchmarkHelpers::MakeUniqueFolderPaths(Random, Config.NumPaths);
+	for (int32 PathIndex = 0; PathIndex < LookupPaths.Num() && !AssignedPaths.IsEmpty(); PathIndex += 4)
+	{
+		LookupPaths[PathIndex] = AssignedPaths[Random.RandHelper(AssignedPaths.Num())];
+	}
+
+	const auto Measure = [&Config, &OutResults](const TCHAR* Operation, int32 NumOps, TFunctionRef<void()> Function)
+	{
+		const int64 StartBytes = BenchmarkHelpers::GetTrackedBytes();
+		int64 NumAllocations = 0;
+		double Seconds = 0.0;
+		{
+			LLM_SCOPE_BYNAME(BenchmarkHelpers::LLMTagName);
+			const int64 StartAllocations = BenchmarkHelpers::GetAllocationCount();
+			const double StartTime = FPlatformTime::Seconds();
+
+			Function();
+
+			Seconds = FPlatformTime::Seconds() - StartTime;
+			NumAllocations = BenchmarkHelpers::GetAllocationCount() - StartAllocations;
+		}
+		const int64 NumBytes = BenchmarkHelpers::GetTrackedBytes() - StartBytes;
+
+		FResult& Result = OutResults.AddDefaulted_GetRef();
+		Result.Seconds = Seconds;
+		Result.NumBytes = NumBytes;
+		Result.NumAllocations = NumAllocations;
+		Result.Operation = Operation;
+		Result.Config = Config;
+		Result.NumOps = NumOps;
+	};
+
+	int32 NumMatches = 0;
+
+	Measure(TEXT("RebuildRules"), 1, [Settings]() { Settings->RebuildRules(true); });
+
+	Measure(
+		TEXT("GetDataForPath (uncached)"),
+		LookupPaths.Num(),
+		[Settings, &LookupPaths, &NumMatches]()
+		{
+			for (const FString& Path : LookupPaths)
+			{
+				Settings->ResolvedDataCache.Remove(Path);
+				NumMatches += Settings->GetDataForPath(Path).IsSet() ? 1 : 0;
+			}
+		}
+	);
+
+	// Only as many paths as the cache holds, so the second pass is all hits
+	const TArrayView<const FString> CachedPaths = MakeArrayView(LookupPaths).Left(UFancyFoldersSettings::ResolvedDataCacheSize);
+	for (const FString& Path : CachedPaths)
+	{
+		Settings->GetDataForPath(Path);
+	}
+
+	Measure(
+		TEXT("GetDataForPath (cached)"),
+		CachedPaths.Num(),
+		[Settings, &CachedPaths, &NumMatches]()
+		{
+			for (const FString& Path : CachedPaths)
+			{
+				NumMatches += Settings->GetDataForPath(Path).IsSet() ? 1 : 0;
+			}
+		}
+	);
+
+	// Half the edits update existing assignments, the other half create new ones
+	TArray<FString> EditedPaths = BenchmarkHelpers::MakeUniqueFolderPaths(Random, FMath::Min(Config.NumPaths, 10000));
+	for (int32 PathIndex = 0; PathIndex < EditedPaths.Num() && !AssignedPaths.IsEmpty(); PathIndex += 2)
+	{
+		EditedPaths[PathIndex] = AssignedPaths[Random.RandHelper(AssignedPaths.Num())];
+	}
+
+	TArray<FFolderData> EditedData;
+	for (int32 PathIndex = 0; PathIndex < EditedPaths.Num(); PathIndex++)
+	{
+		EditedData.Add(BenchmarkHelpers::MakeFolderData(Random));
+	}
+
+	Measure(
+		TEXT("UpdateOrCreateAssignmentIcon"),
+		EditedPaths.Num(),
+		[Settings, &EditedPaths, &EditedData]()
+		{
+			for (int32 PathIndex = 0; PathIndex < EditedPaths.Num(); PathIndex++)
+			{
+				Settings->UpdateOrCreateAssignmentIcon(EditedPaths[PathIndex], EditedData[PathIndex].Icon);
+			}
+		}
+	);
+
+	Measure(
+		TEXT("UpdateOrCreateAssignmentColor"),
+		EditedPaths.Num(),
+		[Settings, &EditedPaths, &EditedData]()
+		{
+			for (int32 PathIndex = 0; PathIndex < EditedPaths.Num(); PathIndex++)
+			{
+				Settings->UpdateOrCreateAssignmentColor(EditedPaths[PathIndex], EditedData[PathIndex].Color);
+			}
+		}
+	);
+
+	Settings->FlushConfig();
+
+	// Same format as the PathColor section of GEditorPerProjectIni
+	TArray<FString> PathColorSection;
+	PathColorSection.Reserve(AssignedPaths.Num());
+	for (const FString& Path : AssignedPaths)
+	{
+		PathColorSection.Add(FString::Printf(TEXT("%s=%s"), *Path, *FLinearColor(Random.FRand(), Random.FRand(), Random.FRand()).ToString()));
+	}
+
+	TMap<FString, FLinearColor> CachedPathColors;
+
+	Measure(
+		TEXT("SyncFolderColorData (all new)"),
+		PathColorSection.Num(),
+		[Settings, &PathColorSection, &CachedPathColors]()
+		{
+			UFancyFoldersSubsystem::ApplyPathColorSection(PathColorSection, CachedPathColors, Settings);
+		}
+	);
+
+	for (int32 EntryIndex = 0; EntryIndex < PathColorSection.Num(); EntryIndex += 100)
+	{
+		PathColorSection[EntryIndex] = FString::Printf(TEXT("%s=%s"), *AssignedPaths[EntryIndex], *FLinearColor(Random.FRand(), Random.FRand(), Random.FRand()).ToString());
+	}
+
+	Measure(
+		TEXT("SyncFolderColorData (1% changed)"),
+		PathColorSection.Num(),
+		[Settings, &PathColorSection, &CachedPathColors]()
+		{
+			UFancyFoldersSubsystem::ApplyPathColorSection(PathColorSection, CachedPathColors, Settings);
+		}
+	);
+
+	UE_LOG(LogFancyFolders, Verbose, TEXT("Benchmark matched %d lookups"), NumMatches);
+
+	Settings->MarkAsGarbage();
+}
+
+FString FFancyFoldersBenchmark::ToJson(const TArray<FResult>& Results)
+{
+	FString Output;
+	const TSharedRef<TJsonWriter<TCHAR, TPrettyJsonPrintPolicy<TCHAR>>> Writer = TJsonWriterFactory<TCHAR, TPrettyJsonPrintPolicy<TCHAR>>::Create(&Output);
+
+	Writer->WriteObjectStart();
+	Writer->WriteValue(TEXT("Platform"), FString(FPlatformProperties::PlatformName()));
+	Writer->WriteValue(TEXT("Date"), FDateTime::UtcNow().ToIso8601());
+	Writer->WriteArrayStart(TEXT("Results"));
+
+	for (const FResult& Result : Results)
+	{
+		Writer->WriteObjectStart();
+		Writer->WriteValue(TEXT("Operation"), Result.Operation);
+		Writer->WriteValue(TEXT("Assignments"), Result.Config.NumAssignments);
+		Writer->WriteValue(TEXT("Presets"), Result.Config.NumPresets);
+		Writer->WriteValue(TEXT("Paths"), Result.Config.NumPaths);
+		Writer->WriteValue(TEXT("Ops"), Result.NumOps);
+		Writer->WriteValue(TEXT("Seconds"), Result.Seconds);
+		Writer->WriteValue(TEXT("OpsPerSecond"), Result.NumOps / FMath::Max(Result.Seconds, UE_DOUBLE_SMALL_NUMBER));
+		Writer->WriteValue(TEXT("NanosecondsPerOp"), Result.Seconds * 1e9 / FMath::Max(Result.NumOps, 1));
+		// Measurements which aren't available in this run are left out rather than written as 0
+		if (BenchmarkHelpers::HasAllocationCounts())
+		{
+			Writer->WriteValue(TEXT("Allocations"), Result.NumAllocations);
+			Writer->WriteValue(TEXT("AllocationsPerOp"), static_cast<double>(Result.NumAllocations) / FMath::Max(Result.NumOps, 1));
+		}
+		if (BenchmarkHelpers::HasTrackedBytes())
+		{
+			Writer->WriteValue(TEXT("LLMBytes"), Result.NumBytes);
+			Writer->WriteValue(TEXT("LLMBytesPerOp"), static_cast<double>(Result.NumBytes) / FMath::Max(Result.NumOps, 1));
+		}
+		Writer->WriteObjectEnd();
+	}
+
+	Writer->WriteArrayEnd();
+	Writer->WriteObjectEnd();
+	Writer->Close();
+
+	return Output;
+}
+
+// Run headless, -llm is required for the LLM bytes and a build with stats for the allocation counts:
+// UnrealEditor-Cmd <Project> -llm -nullrhi -unattended -ExecCmds="Automation RunTests FancyFolders.Benchmark;Quit"
+IMPLEMENT_COMPLEX_AUTOMATION_TEST(FFancyFoldersBenchmarkTest, "FancyFolders.Benchmark", EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter)
+
+void FFancyFoldersBenchmarkTest::GetTests(TArray<FString>& OutBeautifiedNames, TArray<FString>& OutTestCommands) const
+{
+	// Optional overrides: BenchmarkAssignments=1000,10000,100000 BenchmarkPresets=10,100,1000 BenchmarkPaths=20000
+	const TArray<int32> AssignmentSizes = BenchmarkHelpers::ParseSizes(TEXT("BenchmarkAssignments="), {1000, 10000, 100000});
+	const TArray<int32> PresetSizes = BenchmarkHelpers::ParseSizes(TEXT("BenchmarkPresets="), {10, 100, 1000});
+	const TArray<int32> PathSizes = BenchmarkHelpers::ParseSizes(TEXT("BenchmarkPaths="), {20000});
+
+	for (const int32 NumAssignments : AssignmentSizes)
+	{
+		for (const int32 NumPresets : PresetSizes)
+		{
+			for (const int32 NumPaths : PathSizes)
+			{
+				OutBeautifiedNames.Add(FString::Printf(TEXT("%d Assignments %d Presets %d Paths"), NumAssignments, NumPresets, NumPaths));
+				OutTestCommands.Add(FString::Printf(TEXT("%d %d %d"), NumAssignments, NumPresets, NumPaths));
+			}
+		}
+	}
+}
+
+bool FFancyFoldersBenchmarkTest::RunTest(const FString& Parameters)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FFancyFoldersBenchmarkTest::RunTest)
+
+	TArray<FString> Sizes;
+	Parameters.ParseIntoArrayWS(Sizes);
+	if (!TestEqual(TEXT("Number of sizes"), Sizes.Num(), 3))
+	{
+		return false;
+	}
+
+	const FFancyFoldersBenchmark::FConfig Config = {FCString::Atoi(*Sizes[0]), FCString::Atoi(*Sizes[1]), FCString::Atoi(*Sizes[2])};
+
+	if (!BenchmarkHelpers::HasAllocationCounts())
+	{
+		AddWarning(TEXT("Allocation counts are only available in builds with stats, the results won't include them"));
+	}
+	if (!BenchmarkHelpers::HasTrackedBytes())
+	{
+		AddWarning(TEXT("LLM is disabled, run the editor with -llm to include the allocated bytes in the results"));
+	}
+
+	TArray<FFancyFoldersBenchmark::FResult> Results;
+	FFancyFoldersBenchmark::RunConfig(Config, Results);
+
+	for (const FFancyFoldersBenchmark::FResult& Result : Results)
+	{
+		UE_LOG(
+			LogFancyFolders,
+			Display,
+			TEXT("%-40s assignments %6d, presets %4d, paths %6d: %10.1f ns/op, %12.0f ops/s, %8.2f allocations/op, %10.1f LLM bytes/op"),
+			*Result.Operation,
+			Result.Config.NumAssignments,
+			Result.Config.NumPresets,
+			Result.Config.NumPaths,
+			Result.Seconds * 1e9 / FMath::Max(Result.NumOps, 1),
+			Result.NumOps / FMath::Max(Result.Seconds, UE_DOUBLE_SMALL_NUMBER),
+			static_cast<double>(Result.NumAllocations) / FMath::Max(Result.NumOps, 1),
+			static_cast<double>(Result.NumBytes) / FMath::Max(Result.NumOps, 1)
+		);
+	}
+
+	// One file per size combination, in Saved/FancyFolders unless BenchmarkOutput=<directory> is passed
+	FString OutputDirectory;
+	if (!FParse::Value(FCommandLine::Get(), TEXT("BenchmarkOutput="), OutputDirectory))
+	{
+		OutputDirectory = FPaths::ProjectSavedDir() / TEXT("FancyFolders");
+	}
+
+	const FString OutputFile = OutputDirectory / FString::Printf(TEXT("Benchmark-%d-%d-%d-%s.json"), Config.NumAssignments, Config.NumPresets, Config.NumPaths, *FDateTime::Now().ToString());
+	if (!FFileHelper::SaveStringToFile(FFancyFoldersBenchmark::ToJson(Results), *OutputFile))
+	{
+		AddError(FString::Printf(TEXT("Failed to write the benchmark results to %s"), *OutputFile));
+		return false;
+	}
+
+	UE_LOG(LogFancyFolders, Display, TEXT("Benchmark results written to %s"), *OutputFile);
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
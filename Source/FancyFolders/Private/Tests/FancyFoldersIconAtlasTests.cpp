@@ -0,0 +1,85 @@
+﻿// Copyright Out-of-the-Box Plugins 2018-2025. All Rights Reserved.
+
+#include <Engine/Texture2D.h>
+#include <Misc/AutomationTest.h>
+#include <RHI.h>
+
+#include "FancyFolders.h"
+#include "FancyFoldersIconAtlas.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace IconAtlasTestHelpers
+{
+	/**
+	 * Page dimension small enough to force the built-in icons over several pages
+	 */
+	constexpr int32 SmallPageDimension = 512;
+
+	/**
+	 * Builds the atlas from the built-in icons and checks that every brush points into a page within the limit, with a valid UV region not overlapping any other brush. Returns the number of pages
+	 */
+	int32 TestAtlas(FAutomationTestBase& Test, int32 MaxPageDimension, int32 ExpectedPageDimension)
+	{
+		const TArray<FString>& IconFolders = FFancyFoldersModule::GetIconFoldersOnDisk();
+
+		FFancyFoldersIconAtlas Atlas;
+		if (!Test.TestTrue(TEXT("Atlas built"), Atlas.Build(IconFolders, MaxPageDimension)))
+		{
+			return 0;
+		}
+
+		TMap<const UObject*, TArray<FBox2f>> RegionsPerPage;
+		for (int32 IconIndex = 0; IconIndex < IconFolders.Num(); IconIndex++)
+		{
+			for (const EFolderState State : {EFolderState::Normal, EFolderState::ColumnOpen, EFolderState::ColumnClosed})
+			{
+				const FSlateBrush* Brush = Atlas.GetBrush(IconIndex, State);
+				if (!Test.TestNotNull(*FString::Printf(TEXT("Brush of %s (%d)"), *IconFolders[IconIndex], static_cast<int32>(State)), Brush))
+				{
+					continue;
+				}
+
+				const UTexture2D* Page = Cast<UTexture2D>(Brush->GetResourceObject());
+				if (!Test.TestNotNull(TEXT("Brush page"), Page))
+				{
+					continue;
+				}
+
+				Test.TestTrue(TEXT("Page width within the limit"), Page->GetSizeX() <= ExpectedPageDimension);
+				Test.TestTrue(TEXT("Page height within the limit"), Page->GetSizeY() <= ExpectedPageDimension);
+
+				const FBox2f Region = Brush->GetUVRegion();
+				Test.TestTrue(TEXT("UV region valid"), Region.bIsValid);
+				Test.TestTrue(TEXT("UV region not degenerate"), Region.Min.X < Region.Max.X && Region.Min.Y < Region.Max.Y);
+				Test.TestTrue(TEXT("UV region inside the page"), Region.Min.X >= 0.0f && Region.Min.Y >= 0.0f && Region.Max.X <= 1.0f && Region.Max.Y <= 1.0f);
+
+				// The padding between icons keeps neighbouring regions from even touching
+				TArray<FBox2f>& Regions = RegionsPerPage.FindOrAdd(Page);
+				for (const FBox2f& Other : Regions)
+				{
+					Test.TestFalse(TEXT("UV regions overlap"), Region.Intersect(Other));
+				}
+
+				Regions.Add(Region);
+			}
+		}
+
+		Test.TestEqual(TEXT("Number of pages"), RegionsPerPage.Num(), Atlas.GetNumPages());
+		return Atlas.GetNumPages();
+	}
+} // namespace IconAtlasTestHelpers
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FFancyFoldersIconAtlasTest, "FancyFolders.IconAtlas", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FFancyFoldersIconAtlasTest::RunTest(const FString& Parameters)
+{
+	IconAtlasTestHelpers::TestAtlas(*this, INDEX_NONE, GetMax2DTextureDimension());
+
+	const int32 NumSmallPages = IconAtlasTestHelpers::TestAtlas(*this, IconAtlasTestHelpers::SmallPageDimension, IconAtlasTestHelpers::SmallPageDimension);
+	TestTrue(TEXT("Icons split over several pages"), NumSmallPages > 1);
+
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
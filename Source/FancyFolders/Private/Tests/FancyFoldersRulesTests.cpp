@@ -0,0 +1,117 @@
+﻿// Copyright Out-of-the-Box Plugins 2018-2025. All Rights Reserved.
+
+#include <Misc/AutomationTest.h>
+
+#include "FancyFoldersRules.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace RulesTestHelpers
+{
+	/**
+	 * Reference patterns, covering every kind of simplified pattern as well as some which have to stay regex
+	 */
+	const TCHAR* const Patterns[] = {
+		TEXT(""), TEXT(".*"), TEXT("^$"), TEXT("BP_*"), TEXT("/Game/ArchitectureVis_*"), TEXT("^/Game/Maps$"), TEXT("^/Game/"), TEXT("Textures$"),
+		TEXT("^/Game/.*/Materials$"), TEXT("Foo.*Bar"), TEXT("a\\.b"), TEXT("a.b"), TEXT("Debug_*$"), TEXT("x*y"), TEXT("M_[A-Z]+"), TEXT("^(Art|Audio)$"),
+	};
+	/**
+	 * Subjects the reference patterns are matched against
+	 */
+	const TCHAR* const Subjects[] = {
+		TEXT(""), TEXT("BP"), TEXT("BP_Player"), TEXT("bp_player"), TEXT("/Game/ArchitectureVis_Interior"), TEXT("/Game/Maps"), TEXT("/Game/Maps/Sub"),
+		TEXT("/Game/Art/Textures"), TEXT("/Game/Art/Materials"), TEXT("FooXBar"), TEXT("BarFoo"), TEXT("a.b"), TEXT("axb"), TEXT("M_Rock"), TEXT("Art"),
+		TEXT("Debug_"), TEXT("Debug"), TEXT("xy"),
+	};
+	/**
+	 * Patterns matching every subject
+	 */
+	const TCHAR* const CatchAllPatterns[] = {TEXT(""), TEXT(".*")};
+	/**
+	 * Patterns sharing their literal with one of the reference patterns, so several patterns end in the same state of the automaton
+	 */
+	const TCHAR* const SharedLiteralPatterns[] = {TEXT("Textures"), TEXT("^/Game/Maps"), TEXT("/Game/Maps$"), TEXT("BP_"), TEXT("^/Game/.*Maps")};
+
+	/**
+	 * Checks the pattern list picks the same pattern as evaluating every pattern with ICU one by one, in order
+	 */
+	void TestFirstMatches(FAutomationTestBase& Test, const TArray<FString>& PatternStrings)
+	{
+		FFancyFoldersPatternList PatternList;
+		PatternList.Build(PatternStrings);
+
+		for (const TCHAR* Subject : Subjects)
+		{
+			int32 ExpectedMatch = INDEX_NONE;
+			for (int32 PatternIndex = 0; PatternIndex < PatternList.Num() && ExpectedMatch == INDEX_NONE; PatternIndex++)
+			{
+				ExpectedMatch = PatternList[PatternIndex].MatchesRegex(Subject) ? PatternIndex : INDEX_NONE;
+			}
+
+			Test.TestEqual(*FString::Printf(TEXT("First match of '%s' in [%s]"), Subject, *FString::Join(PatternStrings, TEXT(", "))), PatternList.FindFirstMatch(Subject), ExpectedMatch);
+		}
+	}
+} // namespace RulesTestHelpers
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FFancyFoldersPatternsTest, "FancyFolders.Rules.Patterns", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FFancyFoldersPatternsTest::RunTest(const FString& Parameters)
+{
+	// The simplified patterns have to give the same results as ICU regex
+	for (const TCHAR* PatternString : RulesTestHelpers::Patterns)
+	{
+		const FFancyFoldersPattern Pattern(PatternString);
+		if (Pattern.GetKind() == EFancyFoldersPatternKind::Regex)
+		{
+			continue;
+		}
+
+		for (const TCHAR* Subject : RulesTestHelpers::Subjects)
+		{
+			TestEqual(*FString::Printf(TEXT("Pattern '%s' matches '%s'"), PatternString, Subject), Pattern.Matches(Subject), Pattern.MatchesRegex(Subject));
+		}
+	}
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FFancyFoldersPatternListTest, "FancyFolders.Rules.PatternList", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FFancyFoldersPatternListTest::RunTest(const FString& Parameters)
+{
+	// Reference patterns without the catch all patterns at the front, followed by patterns sharing their literals and by all of them again, so every literal is found for several indices
+	const TArray<FString> CatchAllPatterns(RulesTestHelpers::CatchAllPatterns, UE_ARRAY_COUNT(RulesTestHelpers::CatchAllPatterns));
+
+	TArray<FString> BasePatterns;
+	for (const TCHAR* Pattern : RulesTestHelpers::Patterns)
+	{
+		if (!CatchAllPatterns.Contains(Pattern))
+		{
+			BasePatterns.Add(Pattern);
+		}
+	}
+
+	const int32 NumReferencePatterns = BasePatterns.Num();
+	BasePatterns.Append(TArray<FString>(RulesTestHelpers::SharedLiteralPatterns, UE_ARRAY_COUNT(RulesTestHelpers::SharedLiteralPatterns)));
+	BasePatterns.Append(TArray<FString>(BasePatterns.GetData(), NumReferencePatterns));
+
+	RulesTestHelpers::TestFirstMatches(*this, BasePatterns);
+
+	// A catch all pattern at any index has to shadow everything after it, but never what comes before it
+	for (const FString& CatchAll : CatchAllPatterns)
+	{
+		for (int32 InsertIndex = 0; InsertIndex <= BasePatterns.Num(); InsertIndex++)
+		{
+			TArray<FString> PatternStrings = BasePatterns;
+			PatternStrings.Insert(CatchAll, InsertIndex);
+			RulesTestHelpers::TestFirstMatches(*this, PatternStrings);
+		}
+	}
+
+	// The reference list as is, the leading catch all patterns take every subject
+	RulesTestHelpers::TestFirstMatches(*this, TArray<FString>(RulesTestHelpers::Patterns, UE_ARRAY_COUNT(RulesTestHelpers::Patterns)));
+
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
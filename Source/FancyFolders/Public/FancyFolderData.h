@@ -19,10 +19,15 @@ enum class EFolderState
 	ColumnClosed,
 };
 
+/**
+ * Convince function to convert the view flags of a folder into it's state
+ */
+EFolderState StateFromFlags(bool bIsColumnView, bool bIsOpen);
+
 /**
  * Holds icon & color data which can be assigned to a specific, folder, path or a regex match
  */
-USTRUCT()
+USTRUCT(BlueprintType)
 struct FFolderData
 {
 	GENERATED_BODY()
@@ -33,12 +38,12 @@ struct FFolderData
 	/**
 	 * Name of the Icon assigned to a folder
 	 */
-	UPROPERTY(EditAnywhere, Category = "")
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "")
 	FName Icon;
 	/**
 	 * Color assigned to a folder
 	 */
-	UPROPERTY(EditAnywhere, Category = "")
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "")
 	FLinearColor Color;
 	/**
 	 * Convince getter to access the matching FSlateBrush of the current icon based on the desired state
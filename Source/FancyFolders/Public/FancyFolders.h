@@ -5,6 +5,28 @@
 #include <Modules/ModuleInterface.h>
 
 class UContentBrowserFolderContext;
+struct FFileChangeData;
+
+DECLARE_LOG_CATEGORY_EXTERN(LogFancyFolders, Log, All);
+
+/**
+ * Icons available on disk, scanned once and refreshed only when the icon folders change
+ */
+struct FFancyFoldersIconManifest
+{
+	/**
+	 * Folder on disk holding the svg files of each icon
+	 */
+	TArray<FString> IconFolders;
+	/**
+	 * Name of each icon, in the same order as IconFolders
+	 */
+	TArray<FString> IconNames;
+	/**
+	 * Incremented every time the icons on disk change
+	 */
+	uint32 Version = 0;
+};
 
 /**
  * Module responsible for allowing developers to set icons to folders
@@ -15,7 +37,19 @@ public:
 	/**
 	 * Returns all the available icons on disk from the Resources folder
 	 */
-	static TArray<FString> GetIconFoldersOnDisk();
+	static const TArray<FString>& GetIconFoldersOnDisk();
+	/**
+	 * Returns the cached manifest of all the available icons
+	 */
+	static const FFancyFoldersIconManifest& GetIconManifest();
+	/**
+	 * Delegate broadcast after the icons on disk changed and the manifest was rescanned
+	 */
+	static FSimpleMulticastDelegate& OnIconManifestChanged();
+	/**
+	 * Starts watching the icons folder so OnIconManifestChanged fires when icons are added or removed. Does nothing in commandlets or if already watching
+	 */
+	static void WatchIconFolders();
 
 private:
 	// Begin IModuleInterface interface
@@ -30,4 +64,20 @@ private:
 	 * Callback executed to build the IconSelection entries in the context menu
 	 */
 	void BuildContextMenu(FMenuBuilder& MenuBuilder, UContentBrowserFolderContext* Context);
+	/**
+	 * Callback executed when anything inside the icons folder changes, to rescan the manifest
+	 */
+	void OnIconFolderChanged(const TArray<FFileChangeData>& FileChanges);
+	/**
+	 * Returns the folder holding one sub folder per icon
+	 */
+	static FString GetIconsRootFolder();
+	/**
+	 * Scans the icons folder on disk, returns false if the icons are the same as in the manifest
+	 */
+	static bool ScanIconManifest(FFancyFoldersIconManifest& Manifest);
+	/**
+	 * Handle of the directory watcher on the icons folder
+	 */
+	FDelegateHandle IconFolderWatcherHandle;
 };
@@ -0,0 +1,25 @@
+﻿// Copyright Out-of-the-Box Plugins 2018-2025. All Rights Reserved.
+
+#pragma once
+
+#include <Commandlets/Commandlet.h>
+
+#include "FancyFoldersAuditCommandlet.generated.h"
+
+/**
+ * Resolves every folder known to the asset registry through the FancyFolders rules and reports which rule each of them matched,
+ * how many folders each rule matched, the folders without any rule and the rules which never matched.
+ * Usage: UnrealEditor-Cmd <Project> -run=FancyFoldersAudit [Root=/Game,/MyPlugin] [Output=<file>]
+ */
+UCLASS()
+class UFancyFoldersAuditCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UFancyFoldersAuditCommandlet();
+
+	// Begin UCommandlet interface
+	virtual int32 Main(const FString& Params) override;
+	// End UCommandlet interface
+};
@@ -0,0 +1,61 @@
+﻿// Copyright Out-of-the-Box Plugins 2018-2025. All Rights Reserved.
+
+#pragma once
+
+#include <Styling/SlateBrush.h>
+#include <UObject/GCObject.h>
+
+#include "FancyFolderData.h"
+
+class UTexture2D;
+
+/**
+ * Textures (pages) holding the rasterized icons of all folders in all states, so views showing many different icons can be drawn in a few batches
+ */
+class FFancyFoldersIconAtlas final : public FGCObject
+{
+public:
+	/**
+	 * Rasterizes the svg files of all the icon folders and packs them into as many pages as needed. Returns false if no icon could be packed
+	 * MaxPageDimension limits the width & height of the pages, it defaults to the largest texture the RHI supports
+	 */
+	bool Build(const TArray<FString>& IconFolders, int32 MaxPageDimension = INDEX_NONE);
+	/**
+	 * Returns the brush of an icon for the desired state, nullptr if the icon is not part of the atlas
+	 */
+	const FSlateBrush* GetBrush(int32 IconIndex, EFolderState State) const;
+	/**
+	 * Returns the number of textures the icons were packed into
+	 */
+	int32 GetNumPages() const { return Pages.Num(); }
+
+private:
+	// Begin FGCObject interface
+	virtual void AddReferencedObjects(FReferenceCollector& Collector) override;
+	virtual FString GetReferencerName() const override;
+	// End FGCObject interface
+	/**
+	 * Number of values in EFolderState
+	 */
+	static constexpr int32 NumFolderStates = 3;
+	/**
+	 * Resolution multiplier of the rasterized icons, so they stay sharp on high DPI monitors
+	 */
+	static constexpr float RasterScale = 2.0f;
+	/**
+	 * Width of the atlas pages (unless the RHI supports less), the height grows with the number of icons up to the maximum page dimension
+	 */
+	static constexpr int32 AtlasWidth = 1024;
+	/**
+	 * Empty pixels between two icons, so filtering doesn't bleed between them
+	 */
+	static constexpr int32 Padding = 1;
+	/**
+	 * Textures the brushes point into, a new page is started once the previous one reaches the maximum page dimension
+	 */
+	TArray<TObjectPtr<UTexture2D>> Pages;
+	/**
+	 * Brushes of all icons in all states, stored at IconIndex * NumFolderStates + State. Null for icons which failed to rasterize or don't fit a page
+	 */
+	TArray<TUniquePtr<FSlateBrush>> Brushes;
+};
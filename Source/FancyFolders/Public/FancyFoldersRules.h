@@ -0,0 +1,410 @@
+﻿// Copyright Out-of-the-Box Plugins 2018-2025. All Rights Reserved.
+
+#pragma once
+
+#include <Internationalization/Regex.h>
+
+#include "FancyFolderData.h"
+
+struct FPathAssignedData;
+struct FPathPresetData;
+struct FFolderPresetData;
+
+/**
+ * How a preset pattern is evaluated, from the cheapest to the most expensive
+ */
+enum class EFancyFoldersPatternKind : uint8
+{
+	Exact,
+	Prefix,
+	Suffix,
+	Contains,
+	Glob,
+	Regex,
+};
+
+/**
+ * Kind of rule which gave a folder it's data
+ */
+enum class EFancyFoldersRuleKind : uint8
+{
+	None,
+	Assignment,
+	InheritedAssignment,
+	FolderPreset,
+	PathPreset,
+};
+
+/**
+ * Rule which gave a folder it's data, as reported by FFancyFoldersRuleSet::Resolve
+ */
+struct FFancyFoldersRuleMatch
+{
+	/**
+	 * Kind of the matching rule, None if no rule matched
+	 */
+	EFancyFoldersRuleKind Kind = EFancyFoldersRuleKind::None;
+	/**
+	 * Index of the matching preset inside the settings' FolderPresets or PathPresets
+	 */
+	int32 PresetIndex = INDEX_NONE;
+	/**
+	 * Length of the assigned path at the start of the resolved path, for (inherited) assignments
+	 */
+	int32 AssignedPathLength = 0;
+};
+
+/**
+ * Regex pattern classified when compiled, so simple literals, prefixes, suffixes & wildcards are matched with plain string comparisons.
+ * Matches exactly like a case sensitive FRegexMatcher::FindNext, which is still used for the patterns that can't be simplified
+ */
+class FFancyFoldersPattern
+{
+public:
+	explicit FFancyFoldersPattern(const FString& InPattern);
+	/**
+	 * Returns true if the pattern matches anywhere in the subject
+	 */
+	bool Matches(const FString& Subject) const;
+	/**
+	 * Evaluates the pattern with ICU regardless of it's kind, used as reference for the fast paths
+	 */
+	bool MatchesRegex(const FString& Subject) const;
+	/**
+	 * Returns how the pattern is evaluated
+	 */
+	EFancyFoldersPatternKind GetKind() const { return Kind; }
+	/**
+	 * Returns the literal parts of the pattern, empty for regex patterns
+	 */
+	const TArray<FString>& GetSegments() const { return Segments; }
+
+private:
+	/**
+	 * Tries to reduce the pattern to literal segments separated by wildcards, returns false if it uses any other regex feature
+	 */
+	bool Classify(const FString& InPattern);
+	/**
+	 * Evaluates the pattern with string comparisons, only valid for the non regex kinds
+	 */
+	bool MatchesLiterals(const FString& Subject) const;
+	/**
+	 * Compiled regex, always kept so the fast paths can be verified against it
+	 */
+	FRegexPattern Regex;
+	/**
+	 * How the pattern is evaluated
+	 */
+	EFancyFoldersPatternKind Kind = EFancyFoldersPatternKind::Regex;
+	/**
+	 * Literal parts of the pattern, in order. The subject must contain all of them, anything can be between two of them
+	 */
+	TArray<FString> Segments;
+	/**
+	 * Whether the first segment must be at the start of the subject
+	 */
+	bool bAnchoredStart = false;
+	/**
+	 * Whether the last segment must be at the end of the subject
+	 */
+	bool bAnchoredEnd = false;
+};
+
+/**
+ * Matches a subject against a whole list of patterns in a single pass, returning the first pattern of the list which matches.
+ * The literal of every simplified pattern goes into one Aho-Corasick automaton, regex patterns are evaluated one by one but only if they come before the best match
+ */
+class FFancyFoldersPatternList
+{
+public:
+	/**
+	 * Compiles all the patterns and builds the automaton
+	 */
+	void Build(TConstArrayView<FString> InPatterns);
+	/**
+	 * Returns the index of the first pattern matching the subject, INDEX_NONE if none does
+	 */
+	int32 FindFirstMatch(const FString& Subject) const;
+	/**
+	 * Returns the number of patterns
+	 */
+	int32 Num() const { return Patterns.Num(); }
+	/**
+	 * Returns a compiled pattern
+	 */
+	const FFancyFoldersPattern& operator[](int32 Index) const { return Patterns[Index]; }
+
+private:
+	/**
+	 * State of the automaton
+	 */
+	struct FNode
+	{
+		/**
+		 * Next state for each character
+		 */
+		TMap<TCHAR, int32> Next;
+		/**
+		 * State for the longest proper suffix of this state also in the automaton
+		 */
+		int32 Fail = 0;
+		/**
+		 * Closest state in the fail chain which has outputs
+		 */
+		int32 OutputLink = INDEX_NONE;
+		/**
+		 * Length of the literal ending in this state
+		 */
+		int32 Depth = 0;
+		/**
+		 * Patterns whose literal ends in this state, in ascending order
+		 */
+		TArray<int32> Outputs;
+	};
+	/**
+	 * Compiled patterns, in priority order
+	 */
+	TArray<FFancyFoldersPattern> Patterns;
+	/**
+	 * States of the automaton, the root is at index 0
+	 */
+	TArray<FNode> Nodes;
+	/**
+	 * Patterns which are not part of the automaton (regex & empty literals), in ascending order
+	 */
+	TArray<int32> DirectPatterns;
+};
+
+/**
+ * Compact storage of the direct path assignments, laid out as parallel arrays in the order they are saved in:
+ * paths are stored as FNames, icons & colors as indices into palettes of the distinct values used, so the data stays exact.
+ * Derived from the settings' PathAssignments, which stay the saved copy. Entries keep the same order, so an edit can update the matching element of it directly
+ */
+class FCompactPathAssignments
+{
+public:
+	/**
+	 * Removes all the assignments, keeping enough memory for the expected number of assignments
+	 */
+	void Reset(int32 ExpectedNum = 0);
+	/**
+	 * Appends an assignment, e.g. loaded from the config file. Returns false if the path already has an assignment, the new one is then only kept to be saved back
+	 */
+	bool Add(const FString& Path, const FFolderData& Data, bool bApplyToSubfolders);
+	/**
+	 * Returns true if the path has an assignment
+	 */
+	bool Contains(const FString& Path) const;
+	/**
+	 * Returns the data assigned to a path (if any). bOutApplyToSubfolders receives whether the data also applies to the sub folders
+	 */
+	TOptional<FFolderData> Find(const FString& Path, bool* bOutApplyToSubfolders = nullptr) const;
+	/**
+	 * Updates the assignment of a path in place, or appends a new one
+	 */
+	void Set(const FString& Path, const FFolderData& Data, bool bApplyToSubfolders);
+	/**
+	 * Removes the assignment of a path, returns false if the path had no assignment. A later duplicate of the path takes over
+	 */
+	bool Remove(const FString& Path);
+	/**
+	 * Returns the position of the path's effective assignment among all the assignments in their original order (duplicates included), INDEX_NONE if it has none
+	 */
+	int32 IndexOf(const FString& Path) const;
+	/**
+	 * Copies all the assignments out in their original order, duplicates included
+	 */
+	void ToArray(TArray<FPathAssignedData>& OutAssignments) const;
+	/**
+	 * Returns the number of assigned paths
+	 */
+	int32 Num() const { return PathIndices.Num(); }
+	/**
+	 * Returns the number of assignments, duplicates included
+	 */
+	int32 NumEntries() const { return Paths.Num() - NumRemoved; }
+
+private:
+	/**
+	 * Returns the index of the icon inside the palette, adding it if needed
+	 */
+	uint16 FindOrAddIcon(const FName& Icon);
+	/**
+	 * Returns the index of the color inside the palette, adding it if needed
+	 */
+	uint32 FindOrAddColor(const FLinearColor& Color);
+	/**
+	 * Drops the removed entries from the parallel arrays
+	 */
+	void Compact();
+	/**
+	 * Index of the effective (first) assignment of each path inside the parallel arrays
+	 */
+	TMap<FName, int32> PathIndices;
+	/**
+	 * Path of each assignment
+	 */
+	TArray<FName> Paths;
+	/**
+	 * Icon of each assignment, as an index inside IconPalette
+	 */
+	TArray<uint16> IconIndices;
+	/**
+	 * Color of each assignment, as an index inside ColorPalette
+	 */
+	TArray<uint32> ColorIndices;
+	/**
+	 * Whether each assignment also applies to the sub folders
+	 */
+	TBitArray<> ApplyToSubfolders;
+	/**
+	 * Whether each assignment was removed. Removed entries are only skipped so the order doesn't change, until Compact drops them
+	 */
+	TBitArray<> Removed;
+	/**
+	 * Number of removed entries still in the parallel arrays
+	 */
+	int32 NumRemoved = 0;
+	/**
+	 * Number of entries whose path has an earlier assignment
+	 */
+	int32 NumShadowed = 0;
+	/**
+	 * All the distinct icons used by the assignments
+	 */
+	TArray<FName> IconPalette;
+	/**
+	 * Index of each icon inside IconPalette
+	 */
+	TMap<FName, uint16> IconPaletteIndices;
+	/**
+	 * All the distinct colors used by the assignments
+	 */
+	TArray<FLinearColor> ColorPalette;
+	/**
+	 * Index of each color inside ColorPalette
+	 */
+	TMap<FLinearColor, uint32> ColorPaletteIndices;
+};
+
+/**
+ * Trie of path components holding the assignments applied to sub folders, so the nearest parent of a path is found in O(depth)
+ */
+class FInheritedPathTrie
+{
+public:
+	/**
+	 * Removes all the entries
+	 */
+	void Reset();
+	/**
+	 * Updates (or creates) the data inherited by the sub folders of a path
+	 */
+	void Set(const FString& Path, const FFolderData& Data);
+	/**
+	 * Removes the data inherited by the sub folders of a path, returns false if the path had none
+	 */
+	bool Remove(const FString& Path);
+	/**
+	 * Returns the data of the nearest parent of a path with inherited data (if any). The path itself is not considered
+	 * OutParentLength receives the length of that parent's path at the start of Path
+	 */
+	TOptional<FFolderData> FindNearestParent(const FString& Path, int32* OutParentLength = nullptr) const;
+	/**
+	 * Returns the number of paths with inherited data
+	 */
+	int32 Num() const { return NumEntries; }
+
+private:
+	/**
+	 * Returns the node of a path, INDEX_NONE if it doesn't exist (and bCreate is false)
+	 */
+	int32 FindNode(FStringView Path, bool bCreate);
+	/**
+	 * Edges of the trie, from a parent node and a path component to the child node
+	 */
+	TMap<TTuple<int32, FName>, int32> Children;
+	/**
+	 * Inherited data of each node, the root node is at index 0
+	 */
+	TArray<TOptional<FFolderData>> NodeData;
+	/**
+	 * Number of nodes with data
+	 */
+	int32 NumEntries = 0;
+};
+
+/**
+ * Precompiled version of all the rules from the FancyFolders settings, built once and reused for every lookup
+ */
+class FFancyFoldersRuleSet
+{
+public:
+	/**
+	 * Replaces all the direct assignments, e.g. with the ones loaded from the config file. Duplicated paths are reported, only their first assignment is used
+	 */
+	void BuildAssignments(const TArray<FPathAssignedData>& PathAssignments);
+	/**
+	 * Rebuilds the presets from the raw settings data, compiling all the regex patterns
+	 */
+	void BuildPresets(const TArray<FPathPresetData>& PathPresets, const TArray<FFolderPresetData>& FolderPresets);
+	/**
+	 * Resolves the data for a folder based on it's path. Order: direct assignment -> nearest parent applied to sub folders -> folder preset -> path preset
+	 * OutMatch receives the rule the data came from. Safe to call from several threads at once, as long as the rules aren't modified meanwhile
+	 */
+	TOptional<FFolderData> Resolve(const FString& Path, FFancyFoldersRuleMatch* OutMatch = nullptr) const;
+	/**
+	 * Returns the data directly assigned to a path (if any). bOutApplyToSubfolders receives whether the data also applies to the sub folders
+	 */
+	TOptional<FFolderData> FindAssignment(const FString& Path, bool* bOutApplyToSubfolders = nullptr) const;
+	/**
+	 * Returns the position of the path's direct assignment inside the array the assignments were built from, INDEX_NONE if it has none
+	 */
+	int32 FindAssignmentIndex(const FString& Path) const;
+	/**
+	 * Returns the number of direct assignments, duplicates included
+	 */
+	int32 GetNumAssignments() const { return Assignments.NumEntries(); }
+	/**
+	 * Updates (or creates) the direct assignment of a single path without rebuilding the whole rule set
+	 */
+	void SetAssignment(const FString& Path, const FFolderData& Data, bool bApplyToSubfolders = false);
+	/**
+	 * Removes the direct assignment of a single path without rebuilding the whole rule set
+	 */
+	void RemoveAssignment(const FString& Path);
+	/**
+	 * Returns a counter which changes every time any of the rules change, used to invalidate cached results
+	 */
+	uint32 GetGeneration() const { return Generation; }
+
+private:
+	/**
+	 * Data assigned directly to a specific path
+	 */
+	FCompactPathAssignments Assignments;
+	/**
+	 * Direct assignments which also apply to their sub folders
+	 */
+	FInheritedPathTrie InheritedAssignments;
+	/**
+	 * Compiled patterns matching a folder's name
+	 */
+	FFancyFoldersPatternList FolderPatterns;
+	/**
+	 * Data of each folder pattern
+	 */
+	TArray<FFolderData> FolderPresetData;
+	/**
+	 * Compiled patterns matching a folder's full path
+	 */
+	FFancyFoldersPatternList PathPatterns;
+	/**
+	 * Data of each path pattern
+	 */
+	TArray<FFolderData> PathPresetData;
+	/**
+	 * Incremented on every change of the rules
+	 */
+	uint32 Generation = 0;
+};
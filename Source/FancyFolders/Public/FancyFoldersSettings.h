@@ -2,9 +2,12 @@
 
 #pragma once
 
+#include <Containers/LruCache.h>
+#include <Containers/Ticker.h>
 #include <Engine/DeveloperSettings.h>
 
 #include "FancyFolderData.h"
+#include "FancyFoldersRules.h"
 
 #include "FancyFoldersSettings.generated.h"
 
@@ -25,6 +28,11 @@ struct FPathAssignedData
 	 */
 	UPROPERTY(EditAnywhere, Category = "FancyFolders")
 	FFolderData Data;
+	/**
+	 * Also use this data for all the sub folders which don't have an assignment of their own. The nearest parent wins
+	 */
+	UPROPERTY(EditAnywhere, Category = "FancyFolders")
+	bool bApplyToSubfolders = false;
 };
 /**
  * Struct holding data assigned to a folder's path regex match
@@ -63,6 +71,49 @@ struct FFolderPresetData
 	FFolderData Data;
 };
 
+/**
+ * Result of resolving a folder's data, as stored in the resolved folder data cache
+ */
+struct FResolvedFolderData
+{
+	/**
+	 * Data of the first rule matching the folder (if any)
+	 */
+	TOptional<FFolderData> Data;
+	/**
+	 * Index of the data's icon inside the FFancyFoldersStyle brush table, only valid for IconTableVersion
+	 */
+	int32 IconIndex = INDEX_NONE;
+	/**
+	 * Version of the style's icon table IconIndex was looked up in, 0 until the icon is first needed
+	 */
+	uint32 IconTableVersion = 0;
+	/**
+	 * Looks up the icon in the style's brush table unless it's already up to date, returns true if IconIndex was updated.
+	 * Creates the style, so only code drawing the icon should call it
+	 */
+	bool ResolveIconIndex();
+};
+
+/**
+ * Usage statistics of the resolved folder data cache
+ */
+struct FFancyFoldersCacheStats
+{
+	/**
+	 * Number of lookups answered from the cache
+	 */
+	uint64 Hits = 0;
+	/**
+	 * Number of lookups which had to evaluate the rules
+	 */
+	uint64 Misses = 0;
+	/**
+	 * Number of paths currently cached
+	 */
+	int32 Num = 0;
+};
+
 /**
  * Implements the settings for the FancyFolder plugin.
  */
@@ -76,6 +127,10 @@ public:
 	 * Convince function to access a folder's data based on it's path
 	 */
 	TOptional<FFolderData> GetDataForPath(const FString& Path) const;
+	/**
+	 * Returns a folder's data for callers caching it, the icon index is only looked up once they call ResolveIconIndex
+	 */
+	FResolvedFolderData GetResolvedDataForPath(const FString& Path) const;
 	/**
 	 * Get the color assigned to a specific folder (if any)
 	 */
@@ -92,8 +147,51 @@ public:
 	 * Update (or creates) the assignment at a specific path using the provided color. Icon remains unchanged or set to default
 	 */
 	void UpdateOrCreateAssignmentColor(const FString& Path, TOptional<FLinearColor> Color);
+	/**
+	 * Update (or creates) the assignment at a specific path using both the provided icon & color
+	 */
+	void UpdateOrCreateAssignment(const FString& Path, const FFolderData& Data);
+	/**
+	 * Returns the maximum time (in seconds) the folder widgets can be updated for in a single frame
+	 */
+	double GetRefreshTimeBudget() const;
+	/**
+	 * Returns whether the folder icons should be drawn from a single atlas texture
+	 */
+	bool UseIconAtlas() const;
+	/**
+	 * Returns the minimum time (in seconds) between two refreshes of the content browsers, depending on whether the editor has focus
+	 */
+	double GetRefreshInterval(bool bEditorFocused) const;
+	/**
+	 * Returns whether the content browsers are refreshed at all while the editor isn't focused
+	 */
+	bool RefreshWhileUnfocused() const;
+	/**
+	 * Returns whether the content browsers stop being refreshed while playing or simulating in editor
+	 */
+	bool SuspendDuringPIE() const;
+	/**
+	 * Returns a counter which changes every time any of the rules change
+	 */
+	uint32 GetRulesGeneration() const;
+	/**
+	 * Returns the hit/miss counters of the resolved folder data cache
+	 */
+	FFancyFoldersCacheStats GetCacheStats() const;
+	/**
+	 * Resets the hit/miss counters of the resolved folder data cache
+	 */
+	void ResetCacheStats();
+	/**
+	 * Writes pending changes to the config file right away, instead of waiting for the end of the debounce delay
+	 */
+	void FlushConfig();
 
 private:
+	friend class FScopedFancyFoldersBatch;
+	friend class FFancyFoldersBenchmark;
+	friend class UFancyFoldersAuditCommandlet;
 	/**
 	 * Data rules based on a folder's full path
 	 */
@@ -109,7 +207,101 @@ private:
 	 */
 	UPROPERTY(EditAnywhere, config, Category = "FancyFolders")
 	TArray<FFolderPresetData> FolderPresets;
+	/**
+	 * Maximum time spent each frame updating folder widgets. Folders closest to the cursor are updated first, the rest carry over to the next frames
+	 */
+	UPROPERTY(EditAnywhere, config, Category = "Performance", meta = (ClampMin = "0.05", UIMin = "0.05", Units = "ms"))
+	float RefreshTimeBudget = 0.5f;
+	/**
+	 * Rasterize all folder icons into a single texture instead of drawing each one as its own vector image. Reduces draw calls in tile views showing many different icons, at the cost of some sharpness
+	 */
+	UPROPERTY(EditAnywhere, config, Category = "Performance", meta = (ConfigRestartRequired = true))
+	bool bUseIconAtlas = false;
+	/**
+	 * Maximum number of times per second the content browsers are refreshed while the editor is focused
+	 */
+	UPROPERTY(EditAnywhere, config, Category = "Performance", meta = (ClampMin = "1", UIMin = "1", UIMax = "120", Units = "Hz"))
+	float MaxRefreshRate = 30.0f;
+	/**
+	 * Maximum number of times per second the content browsers are refreshed while another application is focused. 0 stops refreshing until the editor is focused again
+	 */
+	UPROPERTY(EditAnywhere, config, Category = "Performance", meta = (ClampMin = "0", UIMin = "0", UIMax = "30", Units = "Hz"))
+	float UnfocusedRefreshRate = 0.0f;
+	/**
+	 * Stop refreshing the content browsers while playing or simulating in editor. When disabled only the content browser under the cursor is refreshed
+	 */
+	UPROPERTY(EditAnywhere, config, Category = "Performance")
+	bool bSuspendDuringPIE = true;
+	/**
+	 * Compiled version of the rules above, used for all the lookups
+	 */
+	FFancyFoldersRuleSet Rules;
+	/**
+	 * Maximum number of paths kept in the resolved folder data cache
+	 */
+	static constexpr int32 ResolvedDataCacheSize = 8192;
+	/**
+	 * Results of previous lookups (including paths without any data), only valid for the ResolvedDataGeneration of the rules
+	 */
+	mutable TLruCache<FString, FResolvedFolderData> ResolvedDataCache{ResolvedDataCacheSize};
+	/**
+	 * Generation of the rules the ResolvedDataCache was filled with
+	 */
+	mutable uint32 ResolvedDataGeneration = 0;
+	/**
+	 * Hit/miss counters of the ResolvedDataCache
+	 */
+	mutable FFancyFoldersCacheStats CacheStats;
+	/**
+	 * Returns the resolved data of a path, from the cache if possible
+	 */
+	FResolvedFolderData FindOrResolveData(const FString& Path) const;
+	/**
+	 * Recompiles the rules after the presets changed. bAssignmentsChanged rebuilds the assignments from PathAssignments as well
+	 */
+	void RebuildRules(bool bAssignmentsChanged);
+	/**
+	 * Returns the index of a path's assignment inside PathAssignments, INDEX_NONE if it has none.
+	 * Rebuilds the assignments of the rules first if PathAssignments was changed behind their back, e.g. through reflection
+	 */
+	int32 FindAssignmentIndex(const FString& Path);
+	/**
+	 * Updates (or creates) the assignment of a path, both in PathAssignments and in the rules
+	 */
+	void SetAssignment(const FString& Path, const FFolderData& Data, bool bApplyToSubfolders = false);
+	/**
+	 * Removes the assignment of a path, both from PathAssignments and from the rules
+	 */
+	void RemoveAssignment(const FString& Path);
+	/**
+	 * Marks the config file as outdated. It's written once the outermost batch ends, or after a short delay when no batch is open
+	 */
+	void MarkConfigDirty();
+	/**
+	 * Ticker callback writing the config file once edits stopped coming in
+	 */
+	bool OnConfigFlushDelayElapsed(float DeltaTime);
+	/**
+	 * Delay after the last edit before the config file is written, so rapid successive edits share a single write
+	 */
+	static constexpr float ConfigFlushDelay = 0.25f;
+	/**
+	 * Number of FScopedFancyFoldersBatch currently open
+	 */
+	int32 BatchDepth = 0;
+	/**
+	 * Whether the config file is missing some of the changes
+	 */
+	bool bConfigDirty = false;
+	/**
+	 * Handle of the pending delayed config write
+	 */
+	FTSTicker::FDelegateHandle ConfigFlushHandle;
 
+	// Begin UObject interface
+	virtual void PostInitProperties() override;
+	virtual void PostReloadConfig(FProperty* PropertyThatWasLoaded) override;
+	// End UObject interface
 	// Begin UDeveloperSettings interface
 	virtual void PreEditChange(FEditPropertyChain& PropertyAboutToChange) override;
 	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
@@ -121,3 +313,21 @@ private:
 #endif
 	// End UDeveloperSettings interface
 };
+
+/**
+ * Groups any number of settings changes, the config file is written once when the outermost batch goes out of scope
+ */
+class FScopedFancyFoldersBatch
+{
+public:
+	explicit FScopedFancyFoldersBatch(UFancyFoldersSettings* InSettings = GetMutableDefault<UFancyFoldersSettings>());
+	~FScopedFancyFoldersBatch();
+
+	UE_NONCOPYABLE(FScopedFancyFoldersBatch)
+
+private:
+	/**
+	 * Settings the changes are applied to
+	 */
+	UFancyFoldersSettings* Settings;
+};
@@ -0,0 +1,61 @@
+﻿// Copyright Out-of-the-Box Plugins 2018-2025. All Rights Reserved.
+
+#pragma once
+
+#include <Stats/Stats.h>
+
+DECLARE_STATS_GROUP(TEXT("FancyFolders"), STATGROUP_FancyFolders, STATCAT_Advanced);
+
+namespace FancyFolders::Stats
+{
+	/**
+	 * Work counted every frame, reported by stat FancyFolders, Insights and FancyFolders.DumpStats
+	 */
+	enum class ECounter : uint8
+	{
+		/**
+		 * Widgets visited while searching the content browsers
+		 */
+		WidgetsVisited,
+		/**
+		 * Folder widgets which had their icon and color assigned
+		 */
+		FoldersAssigned,
+		/**
+		 * Paths resolved through the rules because they weren't cached
+		 */
+		RulesResolved,
+		/**
+		 * ICU regex matches ran by the presets
+		 */
+		RegexEvaluations,
+
+		Num
+	};
+
+	/**
+	 * Adds to the counter of the current frame, safe to call from any thread
+	 */
+	void Add(ECounter Counter, int32 Amount = 1);
+
+	/**
+	 * Closes the current frame, recording it's counters and the time spent ticking the plugin
+	 */
+	void EndFrame(double TickSeconds);
+
+	/**
+	 * Records the time spent in the scope as the plugin's tick and closes the frame once it's left
+	 */
+	class FScopedFrame
+	{
+	public:
+		FScopedFrame();
+		~FScopedFrame();
+
+	private:
+		/**
+		 * Time at which the scope was entered
+		 */
+		uint64 StartCycles;
+	};
+} // namespace FancyFolders::Stats
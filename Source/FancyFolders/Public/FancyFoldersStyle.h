@@ -4,6 +4,19 @@
 
 #include <Styling/SlateStyle.h>
 
+#include "FancyFolderData.h"
+#include "FancyFoldersIconAtlas.h"
+
+/**
+ * Kinds of folders the content browser shows with different default icons
+ */
+enum class EFolderKind : uint8
+{
+	Regular,
+	Code,
+	Developer,
+};
+
 /**
  * Slate style set for FancyFolder plugin
  */
@@ -16,4 +29,70 @@ public:
 	 * Access the singleton instance of this style set
 	 */
 	static FFancyFoldersStyle& Get();
+	/**
+	 * Returns the index of an icon inside the brush table, INDEX_NONE if the icon doesn't exist
+	 */
+	int32 FindIconIndex(const FName& Icon) const;
+	/**
+	 * Returns the brush of an icon for the desired state, nullptr if the index is not valid. Brushes come from the icon atlas if enabled, otherwise they are created the first time they are requested
+	 */
+	const FSlateBrush* GetFolderBrush(int32 IconIndex, EFolderState State);
+	/**
+	 * Returns the content browser's own brush for a kind of folder in the desired state
+	 */
+	const FSlateBrush* GetDefaultFolderBrush(EFolderKind Kind, EFolderState State) const;
+	/**
+	 * Returns the version of the icon manifest the brush table was built from, icon indices are only valid for the same version
+	 */
+	uint32 GetIconTableVersion() const;
+
+private:
+	/**
+	 * Number of values in EFolderState
+	 */
+	static constexpr int32 NumFolderStates = 3;
+	/**
+	 * Number of values in EFolderKind
+	 */
+	static constexpr int32 NumFolderKinds = 3;
+	/**
+	 * Index of each icon inside the brush table
+	 */
+	TMap<FName, int32> IconIndices;
+	/**
+	 * Folder on disk holding the svg files of each icon
+	 */
+	TArray<FString> IconFolders;
+	/**
+	 * Brushes of all icons in all states, stored at IconIndex * NumFolderStates + State. Null until first requested
+	 */
+	TArray<const FSlateBrush*> FolderBrushes;
+	/**
+	 * Creates and registers the brush of an icon in the desired state
+	 */
+	const FSlateBrush* CreateFolderBrush(int32 IconIndex, EFolderState State);
+	/**
+	 * (Re)builds the icon table from the icon manifest, keeping the brushes of icons which still exist
+	 */
+	void BuildIconTable();
+	/**
+	 * Version of the icon manifest the icon table was built from
+	 */
+	uint32 IconTableVersion = 0;
+	/**
+	 * Handle of the icon manifest change delegate
+	 */
+	FDelegateHandle IconManifestChangedHandle;
+	/**
+	 * Rasterized version of all icons, only built if enabled in the settings
+	 */
+	TUniquePtr<FFancyFoldersIconAtlas> IconAtlas;
+	/**
+	 * Atlases replaced after the icons changed, kept alive since widgets might still be drawing their brushes
+	 */
+	TArray<TUniquePtr<FFancyFoldersIconAtlas>> RetiredIconAtlases;
+	/**
+	 * Content browser brushes for each folder kind in each state, stored at Kind * NumFolderStates + State
+	 */
+	const FSlateBrush* DefaultFolderBrushes[NumFolderKinds * NumFolderStates] = {};
 };
\ No newline at end of file
@@ -2,23 +2,29 @@
 
 #pragma once
 
+#include <Containers/Ticker.h>
+#include <ContentBrowserDataSubsystem.h>
 #include <ContentBrowserItem.h>
 #include <EditorSubsystem.h>
 #include <Misc/EngineVersionComparison.h>
+#include <Widgets/Views/STableViewBase.h>
+
+#include "FancyFolderData.h"
+#include "FancyFoldersSettings.h"
+#include "FancyFoldersStyle.h"
 
 #include "FancyFoldersSubsystem.generated.h"
 
+struct FARFilter;
+class SDockTab;
 class SPathView;
 class SAssetView;
 class FTreeItem;
+template <typename ItemType>
+class STreeView;
 
-using FOnGetFolderState = TDelegate<bool()>;
-
-#if UE_VERSION_NEWER_THAN(5, 4, 4)
-using FTreeItemPtr = TSharedPtr<FTreeItem>;
-#else
-using FTreeItemPtr = TWeakPtr<FTreeItem>;
-#endif
+using FPathTreeView = STreeView<TSharedPtr<FTreeItem>>;
+using FOnPathTreeExpansionChanged = TDelegate<void(TSharedPtr<FTreeItem>, bool)>;
 
 /**
  * Struct representing the information about folder - path, image widget, state
@@ -35,25 +41,155 @@ struct FContentBrowserFolder
 	 */
 	TSharedRef<SImage> FolderImage;
 	/**
-	 * Delegate used to determine if the folder is open or closed
-	 */
-	FOnGetFolderState GetFolderState;
-	/**
-	 * Returns the current open/closed state of the folder
+	 * Whether the folder is expanded, only path view folders can be
 	 */
-	bool IsOpenNow() const;
+	bool bIsOpen = false;
 	/**
 	 * Returns the current normal/column state of the folder
 	 */
 	bool IsColumnViewNow() const;
+};
+
+/**
+ * Everything known about a folder's virtual path, gathered once instead of querying the content browser data on every refresh
+ */
+struct FFolderRecord
+{
+	/**
+	 * Whether the content browser has a folder item at the virtual path
+	 */
+	bool bExists = false;
+	/**
+	 * Package path of the folder, e.g.: /All/Game/Maps -> /Game/Maps
+	 */
+	FString PackagePath;
+	/**
+	 * Which default icon the content browser uses for the folder
+	 */
+	EFolderKind Kind = EFolderKind::Regular;
+	/**
+	 * Data resolved from the rules for the package path
+	 */
+	FResolvedFolderData ResolvedData;
+	/**
+	 * Rules generation the data was resolved with
+	 */
+	uint32 RulesGeneration = MAX_uint32;
+};
+
+/**
+ * Folder waiting in the refresh queue to get it's icon & color assigned
+ */
+struct FPendingContentBrowserFolder
+{
+	/**
+	 * VirtualPath of the FolderPath
+	 */
+	FName FolderPath;
+	/**
+	 * Widget representing the folder's image, the queue should not keep it alive
+	 */
+	TWeakPtr<SImage> FolderImage;
 	/**
-	 * Converts a virtual path such as /All/Plugins -> /Plugins or /All/Game -> /Game
+	 * Whether the folder was expanded when it was queued, expansion changes after that are pushed by the tree view
 	 */
-	FString GetPackagePath() const;
+	bool bIsOpen = false;
 	/**
-	 * Returns the matching ContentBrowserItem based on the Folder's VirtualPath
+	 * Squared distance between the folder's image and the cursor, lower values are refreshed first. Updated at the start of every pass
 	 */
-	FContentBrowserItem GetContentBrowserItem() const;
+	double Priority = 0.0;
+};
+
+/**
+ * Asset view list or path view tree whose generated rows are collected by the current refresh pass
+ */
+struct FCollectedTableView
+{
+	/**
+	 * Table view to collect the rows of
+	 */
+	TWeakPtr<STableViewBase> TableView;
+	/**
+	 * Whether the table view is a path view tree, otherwise it's an asset view list
+	 */
+	bool bIsPathTree = false;
+};
+
+/**
+ * Path view tree whose expansion notifications go through the subsystem
+ */
+struct FHookedPathTree
+{
+	/**
+	 * Tree view of the path view
+	 */
+	TWeakPtr<FPathTreeView> TreeView;
+	/**
+	 * Delegate the path view bound to the tree view, still called for every notification
+	 */
+	FOnPathTreeExpansionChanged OriginalDelegate;
+};
+
+/**
+ * Asset view list or path view tree whose scroll notifications go through the subsystem
+ */
+struct FHookedTableView
+{
+	/**
+	 * Table view of the asset view or path view
+	 */
+	TWeakPtr<STableViewBase> TableView;
+	/**
+	 * Delegate the owner bound to the table view (if any), still called for every notification
+	 */
+	FOnTableViewScrolled OriginalDelegate;
+	/**
+	 * Hash of the rows the table view had generated when DetectChanges last looked at it
+	 */
+	uint32 GeneratedRowsHash = 0;
+};
+
+/**
+ * Icon & color last assigned to a folder image
+ */
+struct FAppliedFolderState
+{
+	/**
+	 * Image the state was applied to, used to detect destroyed images and reused addresses
+	 */
+	TWeakPtr<SImage> FolderImage;
+	/**
+	 * Brush last assigned to the image
+	 */
+	const FSlateBrush* Icon = nullptr;
+	/**
+	 * Color last assigned to the image
+	 */
+	FSlateColor Color;
+};
+
+/**
+ * Effective data of a folder, as returned by the batch queries
+ */
+USTRUCT(BlueprintType)
+struct FFancyFolderQueryResult
+{
+	GENERATED_BODY()
+	/**
+	 * Path the data was resolved for
+	 */
+	UPROPERTY(BlueprintReadOnly, Category = "FancyFolders")
+	FString Path;
+	/**
+	 * Whether any assignment or preset applies to the folder
+	 */
+	UPROPERTY(BlueprintReadOnly, Category = "FancyFolders")
+	bool bHasData = false;
+	/**
+	 * Color & icon of the folder, only meaningful if bHasData is set
+	 */
+	UPROPERTY(BlueprintReadOnly, Category = "FancyFolders")
+	FFolderData Data;
 };
 
 /**
@@ -71,7 +207,23 @@ public:
 	/**
 	 * Assigns a certain icon to each folder in the array
 	 */
-	void SetFoldersIcon(const FString& Icon, TArray<FString> Folders);
+	void SetFoldersIcon(const FString& Icon, TConstArrayView<FString> Folders);
+	/**
+	 * Assigns a certain color to each folder in the array, the icon remains unchanged or set to default
+	 */
+	void SetFoldersColor(const FLinearColor& Color, TConstArrayView<FString> Folders);
+	/**
+	 * Assigns both icon & color to each folder in the array
+	 */
+	void SetFoldersData(const FFolderData& Data, TConstArrayView<FString> Folders);
+	/**
+	 * Removes the direct assignments (icon & color) of each folder in the array
+	 */
+	void ClearFolders(TConstArrayView<FString> Folders);
+	/**
+	 * Resolves the effective data of each folder in the array, taking into account rules & presets
+	 */
+	TArray<FFancyFolderQueryResult> ResolveFolders(TConstArrayView<FString> Folders) const;
 	/**
 	 * Checks if a certain path has a direct assignment (not taking into account rules or presets)
 	 */
@@ -80,15 +232,95 @@ public:
 	 * Removes the direct assignment for a path, if it exists (not taking into account rules or presets)
 	 */
 	void ClearFolderIcon(const FString& Path);
+	/**
+	 * Schedules a refresh of all the content browser folders. Refreshes keep running for a short time after the request, so widgets created asynchronously are also covered
+	 */
+	void RequestRefresh();
+	/**
+	 * Assigns a certain icon to all the folders, writing the config once
+	 */
+	UFUNCTION(BlueprintCallable, Category = "FancyFolders", meta = (DisplayName = "Set Folders Icon", ScriptName = "SetFoldersIcon"))
+	void K2_SetFoldersIcon(const TArray<FString>& Folders, FName Icon);
+	/**
+	 * Assigns a certain color to all the folders, writing the config once
+	 */
+	UFUNCTION(BlueprintCallable, Category = "FancyFolders", meta = (DisplayName = "Set Folders Color", ScriptName = "SetFoldersColor"))
+	void K2_SetFoldersColor(const TArray<FString>& Folders, FLinearColor Color);
+	/**
+	 * Assigns both icon & color to all the folders, writing the config once
+	 */
+	UFUNCTION(BlueprintCallable, Category = "FancyFolders", meta = (DisplayName = "Set Folders Data", ScriptName = "SetFoldersData"))
+	void K2_SetFoldersData(const TArray<FString>& Folders, const FFolderData& Data);
+	/**
+	 * Removes the direct assignments of all the folders, writing the config once
+	 */
+	UFUNCTION(BlueprintCallable, Category = "FancyFolders", meta = (DisplayName = "Clear Folders", ScriptName = "ClearFolders"))
+	void K2_ClearFolders(const TArray<FString>& Folders);
+	/**
+	 * Resolves the effective data of all the folders in one call
+	 */
+	UFUNCTION(BlueprintCallable, Category = "FancyFolders", meta = (DisplayName = "Resolve Folders", ScriptName = "ResolveFolders"))
+	TArray<FFancyFolderQueryResult> K2_ResolveFolders(const TArray<FString>& Folders) const;
 
 private:
+	friend class FFancyFoldersBenchmark;
+
 	// Begin UEditorSubsystem interface
 	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
 	// End UEditorSubsystem interface
+	/**
+	 * Registers the per frame work, done once the first content browser shows up so sessions without one don't pay for it
+	 */
+	void Activate();
+	/**
+	 * Ticker executed at a low frequency until the subsystem is activated, checking if any content browser tab is open
+	 */
+	bool ProbeForContentBrowser(float DeltaTime);
+	/**
+	 * Checks if any of the content browser tabs is currently open
+	 */
+	static bool IsAnyContentBrowserTabOpen();
 	/**
 	 * Callback executed after each SlateApplication's Tick
 	 */
 	void OnPostTick(float DeltaTime);
+	/**
+	 * Checks the cheap change signals (windows, rules, icons, editor path colors, asset view types, generated rows) and requests a refresh if any of them changed
+	 */
+	void DetectChanges();
+	/**
+	 * Callback executed when items are added, removed or modified in the content browser
+	 */
+	void OnContentBrowserItemDataUpdated(TArrayView<const FContentBrowserItemDataUpdate> InUpdatedItems);
+	/**
+	 * Callback executed when a content browser shows another folder
+	 */
+	void OnAssetPathChanged(const FString& NewPath);
+	/**
+	 * Callback executed when the filters of a content browser change
+	 */
+	void OnFilterChanged(const FARFilter& NewFilter, bool bIsPrimaryBrowser);
+	/**
+	 * Callback executed when the search text of a content browser changes
+	 */
+	void OnSearchBoxChanged(const FText& SearchText, bool bIsPrimaryBrowser);
+	/**
+	 * Callback executed when the sources view of a content browser is expanded or collapsed
+	 */
+	void OnSourcesViewChanged(bool bExpanded);
+	/**
+	 * Callback executed when the active tab changes or a tab is brought to the foreground
+	 */
+	void OnTabChanged(TSharedPtr<SDockTab> NewTab, TSharedPtr<SDockTab> OldTab);
+	/**
+	 * Callback executed when any window is destroyed
+	 */
+	void OnWindowBeingDestroyed(const SWindow& Window);
+	/**
+	 * Callback executed when the keyboard focus changes, used to detect content browsers opened outside of tabs (e.g.: the content browser drawer)
+	 */
+	void OnFocusChanging(const FFocusEvent& FocusEvent, const FWeakWidgetPath& OldFocusedWidgetPath, const TSharedPtr<SWidget>& OldFocusedWidget, const FWidgetPath& NewFocusedWidgetPath, const TSharedPtr<SWidget>& NewFocusedWidget);
 	/**
 	 * Assigns the new fancy delegates to a folder instance, so we can override the folder's icon & color
 	 */
@@ -96,37 +328,269 @@ private:
 	/**
 	 * Callback executed to determine a folder's icon
 	 */
-	const FSlateBrush* GetIconForFolder(FContentBrowserFolder Folder) const;
+	const FSlateBrush* GetIconForFolder(const FFolderRecord& Record, EFolderState State) const;
 	/**
 	 * Callback executed to determine a folder's color
 	 */
-	FSlateColor GetColorForFolder(FContentBrowserFolder Folder) const;
+	FSlateColor GetColorForFolder(const FFolderRecord& Record) const;
+	/**
+	 * Returns the cached record of a folder, creating it on first use and refreshing it's resolved data if the rules changed. Nullptr if the folder doesn't exist
+	 */
+	const FFolderRecord* FindOrAddFolderRecord(const FName& VirtualPath);
+	/**
+	 * Gathers the record of a folder from the content browser data
+	 */
+	static FFolderRecord MakeFolderRecord(const FName& VirtualPath);
+	/**
+	 * Callback executed when the content browser data is fully refreshed
+	 */
+	void OnContentBrowserItemDataRefreshed();
+	/**
+	 * Callback executed when a content path is mounted or dismounted
+	 */
+	void OnContentPathMountChanged(const FString& AssetPath, const FString& ContentPath);
+	/**
+	 * Starts a new refresh pass over the rows of all the visible views, and re-prioritizes the folders still pending from the previous passes
+	 */
+	void StartCollection();
+	/**
+	 * Returns true while the current refresh pass still has rows to collect
+	 */
+	bool IsCollecting() const { return CollectionViewIndex < CollectionViews.Num(); }
+	/**
+	 * Queues the folders of the generated rows, resuming from the row the last frame stopped at, until EndTime
+	 */
+	void CollectFolders(double EndTime);
+	/**
+	 * Adds the lists of all the visible AssetViews to the refresh pass
+	 */
+	void GatherAssetViewLists();
+	/**
+	 * Adds the trees of all the visible PathViews to the refresh pass
+	 */
+	void GatherPathViewTrees();
+	/**
+	 * Queues the folder shown by a generated asset view row (if any)
+	 */
+	void CollectAssetViewRow(const TSharedRef<SWidget>& RowWidget);
+	/**
+	 * Queues the folder shown by a generated path view row (if any)
+	 */
+	void CollectPathViewRow(const FPathTreeView& TreeView, const TSharedRef<SWidget>& RowWidget);
 	/**
-	 * Ensures all visible AssetView folder images are using the fancy delegates
+	 * Routes the expansion notifications of a path view's tree through the subsystem, so open/closed icons are swapped without polling
 	 */
-	void RefreshAssetViewFolders();
+	void HookPathTreeExpansion(const TSharedRef<FPathTreeView>& TreeView);
 	/**
-	 * Ensures all visible PathView folder images are using the fancy delegates
+	 * Gives the expansion notifications back to the path views
 	 */
-	void RefreshPathViewFolders();
+	void UnhookPathTrees();
 	/**
-	 * Gets all the visible AssetView widgets from the editor windows
+	 * Callback executed when a path view folder is expanded or collapsed
 	 */
-	TArray<TSharedRef<SAssetView>> GetAllAssetViews();
+	void OnPathTreeExpansionChanged(TSharedPtr<FTreeItem> Item, bool bIsExpanded, TWeakPtr<FPathTreeView> WeakTreeView);
 	/**
-	 * Gets all the visible PathView widgets from the editor windows
+	 * Routes the scroll notifications of an asset view list or path view tree through the subsystem, so the rows scrolled into view get refreshed
 	 */
-	TArray<TSharedRef<SPathView>> GetAllPathWidgets();
+	void HookTableViewScrolling(const TSharedRef<STableViewBase>& TableView);
+	/**
+	 * Gives the scroll notifications back to the table views
+	 */
+	void UnhookTableViews();
+	/**
+	 * Callback executed when an asset view list or path view tree is scrolled
+	 */
+	void OnTableViewScrolled(double ScrollOffset, TWeakPtr<STableViewBase> WeakTableView);
+	/**
+	 * Returns the folder shown by a generated path view row (if any)
+	 */
+	static TOptional<FContentBrowserFolder> GetPathTreeRowFolder(const FPathTreeView& TreeView, const ITableRow& Row);
+	/**
+	 * Adds a folder to the refresh queue, prioritized by it's distance to the cursor. Folders already queued keep their entry
+	 */
+	void QueueFolder(const FContentBrowserFolder& Folder);
+	/**
+	 * Returns the refresh priority of a folder image, the squared distance between it and the cursor
+	 */
+	static double GetFolderPriority(const SImage& FolderImage, const FVector2D& CursorPosition);
+	/**
+	 * Assigns the icon & color of the queued folders, closest to the cursor first, until EndTime
+	 */
+	void ProcessPendingFolders(double EndTime);
+	/**
+	 * Forgets the applied state of all the folder images which were destroyed
+	 */
+	void PruneAppliedFolderStates();
+	/**
+	 * Walks all the editor windows once to rebuild the registry of ContentBrowser, AssetView and PathView widgets
+	 */
+	void DiscoverViews();
+	/**
+	 * Gets all the AssetView widgets still alive and on screen from the registry
+	 */
+	TArray<TSharedRef<SAssetView>> GetAllAssetViews() const;
+	/**
+	 * Gets all the PathView widgets still alive and on screen from the registry
+	 */
+	TArray<TSharedRef<SPathView>> GetAllPathWidgets() const;
 	/**
 	 * Ensures the editor data from the GEditorPerProjectIni->PathColor and the FancyFolder color data are in sync
 	 */
 	void SyncFolderColorData();
+	/**
+	 * Parses the entries of a PathColor section and applies the colors which changed since CachedPathColors to the settings
+	 */
+	static void ApplyPathColorSection(const TArray<FString>& Section, TMap<FString, FLinearColor>& CachedPathColors, UFancyFoldersSettings* Settings);
+	/**
+	 * Writes the colors of the folders to GEditorPerProjectIni->PathColor, without having the next sync read them back
+	 */
+	void ApplyPathColors(TConstArrayView<FString> Folders, TOptional<FLinearColor> Color);
+	/**
+	 * Returns a hash of the GEditorPerProjectIni->PathColor section, computed without copying it
+	 */
+	static uint32 HashPathColorSection();
 	/**
 	 * Checks if we should be running the expansive content browser updates
 	 */
 	bool ShouldUpdateContentBrowsers() const;
+	/**
+	 * Returns true while no refresh should run at all, during PIE or while the editor isn't focused
+	 */
+	bool IsRefreshSuspended() const;
+	/**
+	 * Returns true if the view is drawn, false if it's inside a background tab, a collapsed drawer or a minimized window
+	 */
+	static bool IsViewOnScreen(const TSharedRef<SWidget>& View);
 	/**
 	 * PathColors values from last FolderColorData sync
 	 */
 	TMap<FString, FLinearColor> CachedPathColors;
+	/**
+	 * Hash of the PathColor section CachedPathColors was parsed from
+	 */
+	uint32 CachedPathColorsHash = 0;
+	/**
+	 * Interval (in seconds) between two checks of the PathColor section's hash by DetectChanges, it's linear in the number of colored folders
+	 */
+	static constexpr double PathColorPollInterval = 1.0;
+	/**
+	 * Time DetectChanges next checks the PathColor section's hash
+	 */
+	double NextPathColorPollTime = 0.0;
+	/**
+	 * Number of entries in the PathColor section seen by DetectChanges, checked on every poll as it's free
+	 */
+	int32 LastNumPathColors = 0;
+	/**
+	 * Folders waiting to be refreshed, kept as a heap whose top is the folder closest to the cursor
+	 */
+	TArray<FPendingContentBrowserFolder> PendingFolders;
+	/**
+	 * Images of the PendingFolders, so a folder collected again by a later pass isn't queued twice
+	 */
+	TSet<const SImage*> PendingImages;
+	/**
+	 * Table views whose rows are collected by the current refresh pass
+	 */
+	TArray<FCollectedTableView> CollectionViews;
+	/**
+	 * Index of the table view the current refresh pass continues with
+	 */
+	int32 CollectionViewIndex = 0;
+	/**
+	 * Index of the row (inside the table view) the current refresh pass continues with
+	 */
+	int32 CollectionRowIndex = 0;
+	/**
+	 * Path view trees currently routing their expansion notifications through the subsystem
+	 */
+	TArray<FHookedPathTree> HookedPathTrees;
+	/**
+	 * Table views currently routing their scroll notifications through the subsystem
+	 */
+	TArray<FHookedTableView> HookedTableViews;
+	/**
+	 * Cached record of each folder's virtual path
+	 */
+	TMap<FName, FFolderRecord> FolderRecords;
+	/**
+	 * State last applied to each folder image, so unchanged images are not invalidated again
+	 */
+	TMap<const SImage*, FAppliedFolderState> AppliedFolderStates;
+	/**
+	 * Registry of the ContentBrowser widgets found during the last discovery
+	 */
+	TArray<TWeakPtr<SWidget>> ContentBrowsers;
+	/**
+	 * Registry of the AssetView widgets found during the last discovery
+	 */
+	TArray<TWeakPtr<SAssetView>> AssetViews;
+	/**
+	 * Registry of the PathView widgets found during the last discovery
+	 */
+	TArray<TWeakPtr<SPathView>> PathViews;
+	/**
+	 * True when windows or tabs changed since the last discovery
+	 */
+	bool bViewsDirty = true;
+	/**
+	 * Number of top level windows seen by DetectChanges
+	 */
+	int32 LastTopLevelWindowCount = 0;
+	/**
+	 * True once the first content browser showed up and the per frame work is registered
+	 */
+	bool bActive = false;
+	/**
+	 * Interval (in seconds) between two checks for content browsers while the subsystem is not active
+	 */
+	static constexpr float ActivationProbeInterval = 1.0f;
+	/**
+	 * Handle of the ticker checking for content browsers while the subsystem is not active
+	 */
+	FTSTicker::FDelegateHandle ActivationProbeHandle;
+	/**
+	 * Time (in seconds) refreshes keep running for after a change was detected
+	 */
+	static constexpr double RefreshSettleTime = 0.5;
+	/**
+	 * Time until which the content browsers need to be refreshed
+	 */
+	double RefreshDeadline = 0.0;
+	/**
+	 * True from a refresh request until a refresh pass starts, so requests made while refreshing is suspended aren't lost once their deadline passed
+	 */
+	bool bRefreshPending = false;
+	/**
+	 * Time the change signals were last checked & the views last refreshed, used to limit the refresh rate
+	 */
+	double LastRefreshTime = 0.0;
+	/**
+	 * Hash of the view types of all the registered asset views seen by DetectChanges
+	 */
+	uint32 LastAssetViewTypesHash = 0;
+	/**
+	 * Settings rules generation seen by DetectChanges
+	 */
+	uint32 LastRulesGeneration = 0;
+	/**
+	 * Style icon table version seen by DetectChanges
+	 */
+	uint32 LastIconTableVersion = 0;
+	/**
+	 * Handles of the delegates used to detect changes
+	 */
+	FDelegateHandle PostTickHandle;
+	FDelegateHandle ItemDataUpdatedHandle;
+	FDelegateHandle ItemDataRefreshedHandle;
+	FDelegateHandle ContentPathMountedHandle;
+	FDelegateHandle ContentPathDismountedHandle;
+	FDelegateHandle ActiveTabChangedHandle;
+	FDelegateHandle TabForegroundedHandle;
+	FDelegateHandle WindowBeingDestroyedHandle;
+	FDelegateHandle FocusChangingHandle;
+	FDelegateHandle AssetPathChangedHandle;
+	FDelegateHandle FilterChangedHandle;
+	FDelegateHandle SearchBoxChangedHandle;
+	FDelegateHandle SourcesViewChangedHandle;
 };
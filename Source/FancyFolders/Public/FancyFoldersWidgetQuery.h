@@ -0,0 +1,92 @@
+﻿// Copyright Out-of-the-Box Plugins 2018-2025. All Rights Reserved.
+
+#pragma once
+
+#include <Widgets/SWidget.h>
+
+namespace FancyFolders
+{
+	/**
+	 * Decision returned by a widget visitor to control how the query continues
+	 */
+	enum class EWidgetQueryResult
+	{
+		/**
+		 * Keep going, including the children of the current widget
+		 */
+		Continue,
+		/**
+		 * Keep going, but don't visit the children of the current widget
+		 */
+		SkipChildren,
+		/**
+		 * Stop the query right away
+		 */
+		Stop,
+	};
+
+	/**
+	 * Options controlling which parts of a widget hierarchy a query visits
+	 */
+	struct FWidgetQuery
+	{
+		/**
+		 * Maximum depth (relative to the root widgets) to visit, INDEX_NONE for unlimited
+		 */
+		int32 MaxDepth = INDEX_NONE;
+		/**
+		 * If true, collapsed and hidden widgets are skipped together with their whole subtree
+		 */
+		bool bSkipHiddenWidgets = true;
+		/**
+		 * If true, the child windows of each SWindow are visited as well
+		 */
+		bool bIncludeChildWindows = false;
+	};
+
+	using FWidgetVisitor = TFunctionRef<EWidgetQueryResult(const TSharedRef<SWidget>& Widget)>;
+
+	/**
+	 * Visits the widgets in depth first order (parents before children, children in order) until the visitor stops the query
+	 * Returns false if the query was stopped by the visitor
+	 */
+	bool VisitWidgets(TConstArrayView<TSharedRef<SWidget>> Roots, const FWidgetQuery& Query, FWidgetVisitor Visitor);
+
+	/**
+	 * Returns the widget type of T. The name is only built once, comparing it afterward is a plain integer comparison
+	 */
+	template <typename T>
+	const FName& GetWidgetTypeName()
+	{
+		static const FName WidgetType = T::StaticWidgetClass().GetWidgetType();
+		return WidgetType;
+	}
+
+	/**
+	 * Returns the first visible widget of the desired type under Parent (Parent included), stopping the search as soon as it's found
+	 */
+	template <typename T>
+	TSharedPtr<T> FindChildWidgetOfType(const TSharedRef<SWidget>& Parent, const FName& WidgetType = GetWidgetTypeName<T>(), const FWidgetQuery& Query = {})
+	{
+		TRACE_CPUPROFILER_EVENT_SCOPE(FancyFolders::FindChildWidgetOfType)
+
+		TSharedPtr<SWidget> Result;
+
+		VisitWidgets(
+			MakeArrayView(&Parent, 1),
+			Query,
+			[&Result, &WidgetType](const TSharedRef<SWidget>& Widget)
+			{
+				if (Widget->GetType() == WidgetType && Widget->GetVisibility() == EVisibility::Visible)
+				{
+					Result = Widget;
+					return EWidgetQueryResult::Stop;
+				}
+
+				return EWidgetQueryResult::Continue;
+			}
+		);
+
+		return StaticCastSharedPtr<T>(Result);
+	}
+} // namespace FancyFolders